@@ -9,6 +9,7 @@ NEED_BPP                 := 32
 WANT_NEW_API             := 1
 NEED_STEREO_SOUND        := 1
 HAVE_THREADS             := 1
+HAVE_MMAP                := 1
 NEED_CD                  := 1
 NEED_SCSI_CD             := 1
 NEED_TREMOR              := 1
@@ -35,6 +35,7 @@
 #include "mednafen/cdrom/scsicd.h"
 #include "mednafen/mempatcher.h"
 #include "mednafen/cdrom/cdromif.h"
+#include "mednafen/cdrom/CDAccess_BlockCache.h"
 #include "mednafen/md5.h"
 #include "mednafen/clamp.h"
 #include "mednafen/state_helpers.h"
@@ -486,7 +487,7 @@ static bool LoadCommon(std::vector<CDIF *> *CDInterfaces)
    }
 
    SoundBox_Init(MDFN_GetSettingB("pcfx.adpcm.emulate_buggy_codec"), MDFN_GetSettingB("pcfx.adpcm.suppress_channel_reset_clicks"));
-   RAINBOW_Init(MDFN_GetSettingB("pcfx.rainbow.chromaip"));
+   RAINBOW_Init(MDFN_GetSettingB("pcfx.rainbow.chromaip"), MDFN_GetSettingB("pcfx.rainbow.threaded"), MDFN_GetSettingUI("pcfx.rainbow.cache_size") << 20);
    FXINPUT_Init();
    FXTIMER_Init();
 
@@ -797,6 +798,14 @@ static void CloseGame(void)
       }
    }
 
+   if (MDFN_GetSettingUI("pcfx.rainbow.cache_size"))
+   {
+      uint64 hits, misses;
+
+      RAINBOW_GetCacheStats(&hits, &misses);
+      log_cb(RETRO_LOG_INFO, "RAINBOW decode cache: %llu hits, %llu misses.\n", (unsigned long long)hits, (unsigned long long)misses);
+   }
+
    RAINBOW_Close();
    KING_Close();
    SoundBox_Kill();
@@ -1205,6 +1214,12 @@ static void check_variables(bool loaded)
       if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
          if (strcmp(var.value, "enabled") == 0)
             cdimagecache = true;
+
+      var.key            = "pcfx_audio_rate";
+      setting_audio_rate = 44100;
+
+      if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+         setting_audio_rate = atoi(var.value);
    }
 
    var.key = "pcfx_high_dotclock_width";
@@ -1275,6 +1290,66 @@ static void check_variables(bool loaded)
          setting_rainbow_chromaip = 1;
    }
 
+   var.key = "pcfx_rainbow_threaded";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_rainbow_threaded = 0;
+      else if (strcmp(var.value, "enabled") == 0)
+         setting_rainbow_threaded = 1;
+   }
+
+   var.key = "pcfx_rainbow_cache_size";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_rainbow_cache_size = 0;
+      else
+         setting_rainbow_cache_size = atoi(var.value);
+   }
+
+   var.key = "pcfx_cdda_cache_size";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_cdda_cache_size = 0;
+      else
+         setting_cdda_cache_size = atoi(var.value);
+   }
+
+   var.key = "pcfx_cd_readahead_size";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      setting_cd_readahead_size = atoi(var.value);
+
+   var.key = "pcfx_chd_cache_size";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      setting_chd_cache_hunks = atoi(var.value);
+
+   var.key = "pcfx_chd_prefetch";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_chd_prefetch_hunks = 0;
+      else
+         setting_chd_prefetch_hunks = atoi(var.value);
+   }
+
+   var.key = "pcfx_cd_block_cache_size";
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (strcmp(var.value, "disabled") == 0)
+         setting_cd_block_cache_size = 0;
+      else
+         setting_cd_block_cache_size = atoi(var.value);
+   }
+
    var.key = "pcfx_mouse_sensitivity";
 
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
@@ -1586,8 +1661,30 @@ void retro_unload_game(void)
 
    MDFNMP_Kill();
 
+   {
+      CDAccess_BlockCacheStats bc;
+
+      if (CDAccess_BlockCache_GetStats(&bc))
+         log_cb(RETRO_LOG_INFO, "CD block cache: %llu/%llu KB used, %u of %u blocks protected, %llu hits, %llu misses, %llu evictions.\n",
+               (unsigned long long)(bc.used_bytes >> 10), (unsigned long long)(bc.budget_bytes >> 10), bc.protected_blocks, bc.blocks, (unsigned long long)bc.hits, (unsigned long long)bc.misses, (unsigned long long)bc.evictions);
+   }
+
    for (unsigned i = 0; i < CDInterfaces.size(); i++)
+   {
+      CDIF::ReadAheadStats ra;
+      CDAccess::CacheStats ic;
+
+      if (CDInterfaces[i]->GetReadAheadStats(&ra))
+         log_cb(RETRO_LOG_INFO, "CD read-ahead (disc %u): %u sector buffer, depth %u, %llu hits, %llu stalls.\n",
+               i + 1, ra.buffer_size, ra.depth, (unsigned long long)ra.hits, (unsigned long long)ra.stalls);
+
+      if (CDInterfaces[i]->GetImageCacheStats(&ic))
+         log_cb(RETRO_LOG_INFO, "CD image cache (disc %u): %u entries, %llu hits, %llu misses, %llu prefetched, %llu ms decompressing.\n",
+               i + 1, ic.entries, (unsigned long long)ic.hits, (unsigned long long)ic.misses, (unsigned long long)ic.prefetched,
+               (unsigned long long)(ic.decompress_us / 1000));
+
       delete CDInterfaces[i];
+   }
    CDInterfaces.clear();
 
    disc_clear();
@@ -1686,7 +1783,7 @@ void retro_run()
 
    EmulateSpecStruct spec  = {0};
    spec.surface            = &surf;
-   spec.SoundRate          = 44100.0;
+   spec.SoundRate          = setting_audio_rate;
    spec.SoundBuf           = sound_buf;
    spec.LineWidths         = rects;
    spec.SoundBufMaxSize    = sizeof(sound_buf) / 2;
@@ -1769,7 +1866,7 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 {
    memset(info, 0, sizeof(*info));
    info->timing.fps            = MEDNAFEN_CORE_TIMING_FPS;
-   info->timing.sample_rate    = 44100;
+   info->timing.sample_rate    = setting_audio_rate;
    info->geometry.base_width   = MEDNAFEN_CORE_GEOMETRY_BASE_W;
    info->geometry.base_height  = MEDNAFEN_CORE_GEOMETRY_BASE_H;
    info->geometry.max_width    = MEDNAFEN_CORE_GEOMETRY_MAX_W;
@@ -1798,7 +1895,7 @@ void retro_deinit()
       log_cb(RETRO_LOG_INFO, "[%s]: Samples / Frame: %.5f\n",
             mednafen_core_str, (double)audio_frames / video_frames);
       log_cb(RETRO_LOG_INFO, "[%s]: Estimated FPS: %.5f\n",
-            mednafen_core_str, (double)video_frames * 44100 / audio_frames);
+            mednafen_core_str, (double)video_frames * setting_audio_rate / audio_frames);
    }
 }
 
@@ -40,6 +40,81 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "disabled"
    },
+   {
+      "pcfx_cdda_cache_size",
+      "CD-DA Decode Cache Size (MB) (Restart)",
+      "Decode compressed (Ogg Vorbis) CD audio tracks into memory on a background thread, so that CD-DA seeks and loops don't have to decode again. Tracks beyond the size limit are decoded on demand.",
+      {
+         { "disabled", NULL },
+         { "64",       NULL },
+         { "128",      NULL },
+         { "256",      NULL },
+         { "512",      NULL },
+         { "1024",     NULL },
+         { NULL, NULL},
+      },
+      "disabled"
+   },
+   {
+      "pcfx_cd_readahead_size",
+      "CD Read-Ahead Buffer (Sectors) (Restart)",
+      "Number of CD sectors buffered by the background disc reader. Sequential reads such as FMV and CD audio are read further ahead the longer they run, up to half of this. Larger buffers help with slow storage like SD cards, at about 2.4 KB per sector. Has no effect with CD Image Cache enabled.",
+      {
+         { "256",  NULL },
+         { "512",  NULL },
+         { "1024", NULL },
+         { "2048", NULL },
+         { "4096", NULL },
+         { NULL, NULL},
+      },
+      "256"
+   },
+   {
+      "pcfx_chd_cache_size",
+      "CHD Hunk Cache (Hunks) (Restart)",
+      "Number of decompressed hunks kept for CHD disc images, so that seeking back or switching between data and CD audio doesn't decompress the same data again. CD CHD hunks are usually about 19 KB (8 sectors).",
+      {
+         { "16",   NULL },
+         { "32",   NULL },
+         { "64",   NULL },
+         { "128",  NULL },
+         { "256",  NULL },
+         { "512",  NULL },
+         { "1024", NULL },
+         { NULL, NULL},
+      },
+      "64"
+   },
+   {
+      "pcfx_chd_prefetch",
+      "CHD Prefetch (Hunks) (Restart)",
+      "Number of CHD hunks decompressed ahead of sequential reads on a background thread.",
+      {
+         { "disabled", NULL },
+         { "2",        NULL },
+         { "4",        NULL },
+         { "8",        NULL },
+         { "16",       NULL },
+         { NULL, NULL},
+      },
+      "4"
+   },
+   {
+      "pcfx_cd_block_cache_size",
+      "CD Block Cache Size (MB) (Restart)",
+      "Keep recently read parts of the CD images in memory, up to this much for all discs together. Parts read more than once, like boot files, directories and replayed FMV, are kept in preference to ones read only once. Has no effect with CD Image Cache enabled.",
+      {
+         { "disabled", NULL },
+         { "16",       NULL },
+         { "32",       NULL },
+         { "64",       NULL },
+         { "128",      NULL },
+         { "256",      NULL },
+         { "512",      NULL },
+         { NULL, NULL},
+      },
+      "disabled"
+   },
    {
       "pcfx_high_dotclock_width",
       "High Dotclock Width (Restart)",
@@ -89,6 +164,18 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "3",
    },
+   {
+      "pcfx_audio_rate",
+      "Audio Output Rate (Restart)",
+      "Sample rate of the audio handed to the frontend. Set this to the rate of the audio driver so that the emulated sound is resampled only once, by the core.",
+      {
+         { "44100", "44.1 kHz" },
+         { "48000", "48 kHz" },
+         { "96000", "96 kHz" },
+         { NULL, NULL },
+      },
+      "44100",
+   },
    {
       "pcfx_rainbow_chromaip",
       "Chroma channel bilinear interpolation  (Restart)",
@@ -100,6 +187,32 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "disabled",
    },
+   {
+      "pcfx_rainbow_threaded",
+      "Threaded RAINBOW Decoding (Restart)",
+      "Decode RAINBOW (motion JPEG) video blocks on a separate thread, overlapping the decode with emulation of the 16 scanlines before the block is displayed. Output is identical to single-threaded decoding.",
+      {
+         { "disabled",      NULL },
+         { "enabled",      NULL },
+         { NULL, NULL},
+      },
+      "disabled",
+   },
+   {
+      "pcfx_rainbow_cache_size",
+      "RAINBOW Decode Cache Size (MB) (Restart)",
+      "Keep recently decoded RAINBOW (motion JPEG) video blocks in memory, so that looping or repeated video is not decoded again. Larger caches cover longer stretches of video.",
+      {
+         { "disabled", NULL },
+         { "8",        NULL },
+         { "16",       NULL },
+         { "32",       NULL },
+         { "64",       NULL },
+         { "128",      NULL },
+         { NULL, NULL},
+      },
+      "disabled",
+   },
    {
       "pcfx_nospritelimit",
       "No Sprite Limit (Restart)",
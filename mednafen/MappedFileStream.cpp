@@ -0,0 +1,164 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string.h>
+
+#include "mednafen.h"
+#include "MappedFileStream.h"
+
+#ifdef HAVE_MMAP
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFileStream *MappedFileStream::Open(const char *path, bool populate)
+{
+#ifdef HAVE_MMAP
+   struct stat st;
+   int flags = MAP_PRIVATE;
+   void *m;
+   int fd = open(path, O_RDONLY);
+
+   if(fd < 0)
+      return NULL;
+
+   if(fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size <= 0 || (uint64)st.st_size > (size_t)-1)
+   {
+      ::close(fd);
+      return NULL;
+   }
+
+#ifdef MAP_POPULATE
+   if(populate)
+      flags |= MAP_POPULATE;
+#endif
+
+   m = mmap(NULL, st.st_size, PROT_READ, flags, fd, 0);
+   ::close(fd);
+
+   if(m == MAP_FAILED)
+      return NULL;
+
+#ifndef MAP_POPULATE
+   if(populate)
+      madvise(m, st.st_size, MADV_WILLNEED);
+#endif
+
+   return new MappedFileStream((uint8 *)m, st.st_size);
+#else
+   return NULL;
+#endif
+}
+
+MappedFileStream::MappedFileStream(uint8 *mapping_, uint64_t mapping_size_) : mapping(mapping_), mapping_size(mapping_size_), position(0)
+{
+
+}
+
+MappedFileStream::~MappedFileStream()
+{
+   close();
+}
+
+uint64_t MappedFileStream::read(void *data, uint64_t count)
+{
+   if(position >= mapping_size)
+      return 0;
+
+   if(count > mapping_size - position)
+      count = mapping_size - position;
+
+   memcpy(data, mapping + position, count);
+   position += count;
+
+   return count;
+}
+
+void MappedFileStream::write(const void *data, uint64_t count)
+{
+}
+
+void MappedFileStream::seek(int64_t offset, int whence)
+{
+   switch(whence)
+   {
+      case SEEK_SET:
+         position = offset;
+         break;
+
+      case SEEK_CUR:
+         position += offset;
+         break;
+
+      case SEEK_END:
+         position = mapping_size + offset;
+         break;
+   }
+}
+
+void MappedFileStream::truncate(uint64_t length)
+{
+}
+
+void MappedFileStream::flush(void)
+{
+}
+
+uint64_t MappedFileStream::tell(void)
+{
+   return position;
+}
+
+uint64_t MappedFileStream::size(void)
+{
+   return mapping_size;
+}
+
+void MappedFileStream::close(void)
+{
+#ifdef HAVE_MMAP
+   if(mapping)
+      munmap(mapping, mapping_size);
+#endif
+   mapping = NULL;
+   mapping_size = 0;
+   position = 0;
+}
+
+void MappedFileStream::prefetch(uint64_t offset, uint64_t count)
+{
+#ifdef HAVE_MMAP
+   const uint64_t page_mask = (uint64_t)sysconf(_SC_PAGESIZE) - 1;
+   uint64_t start, end;
+
+   if(offset >= mapping_size)
+      return;
+
+   if(count > mapping_size - offset)
+      count = mapping_size - offset;
+
+   start = offset & ~page_mask;
+   end = offset + count;
+
+   // Not MADV_SEQUENTIAL; changing the advice on a part of the mapping splits it, and many
+   // small reads could run the process out of mappings.
+   madvise(mapping + start, end - start, MADV_WILLNEED);
+#endif
+}
@@ -0,0 +1,60 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __MDFN_MAPPEDFILESTREAM_H
+#define __MDFN_MAPPEDFILESTREAM_H
+
+#include "Stream.h"
+
+// Read-only stream over a memory-mapped file; read() copies straight out of the page cache,
+// and map() gives direct access to the whole file.
+class MappedFileStream : public Stream
+{
+   public:
+      // Returns NULL if the file can't be mapped(no mmap() support, not a plain file, empty,
+      // or too large for the address space); use FileStream then.
+      //
+      // If "populate" is set, the whole file is read into memory up front.
+      static MappedFileStream *Open(const char *path, bool populate);
+
+      virtual ~MappedFileStream();
+
+      INLINE const uint8 *map(void) const
+      {
+         return mapping;
+      }
+
+      virtual uint64_t read(void *data, uint64_t count);
+      virtual void write(const void *data, uint64_t count);
+      virtual void seek(int64_t offset, int whence);
+      virtual void truncate(uint64_t length);
+      virtual void flush(void);
+      virtual uint64_t tell(void);
+      virtual uint64_t size(void);
+      virtual void close(void);
+
+      virtual void prefetch(uint64_t offset, uint64_t count);
+
+   private:
+      MappedFileStream(uint8 *mapping_, uint64_t mapping_size_);
+
+      uint8 *mapping;
+      uint64_t mapping_size;
+      uint64_t position;
+};
+
+#endif
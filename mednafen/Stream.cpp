@@ -30,6 +30,11 @@ Stream::~Stream()
 
 }
 
+void Stream::prefetch(uint64_t offset, uint64_t count)
+{
+
+}
+
 int Stream::get_line(std::string &str)
 {
    uint8_t c;
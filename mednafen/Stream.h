@@ -38,6 +38,10 @@ class Stream
       // stream is writeable; it will be called automatically from the destructor, with any
       // exceptions thrown caught and logged.
 
+      // Hints that "count" bytes from "offset" are about to be read, in order; streams that can
+      // start fetching them in the background(MappedFileStream) do so.  Doesn't move the position.
+      virtual void prefetch(uint64_t offset, uint64_t count);
+
       //
       // Utility functions(TODO):
       //
@@ -28,6 +28,7 @@
 #include <mednafen/mednafen.h>
 #include "CDAFReader.h"
 #include "CDAFReader_Vorbis.h"
+#include "CDAFReader_Cache.h"
 #ifdef HAVE_MPC
 #include "CDAFReader_MPC.h"
 #endif
@@ -44,10 +45,29 @@ CDAFReader::~CDAFReader()
 
 CDAFReader* CDAFR_Open(Stream* fp)
 {
+ // Tried in turn; a reader that doesn't recognize the stream throws.  HAVE_MPC needs libmpcdec, which isn't part of this
+ // tree, so Musepack tracks are currently rejected.
+ static CDAFReader* (* const OpenFuncs[])(Stream* fp) =
+ {
 #ifdef HAVE_MPC
-  return CDAFR_MPC_Open(fp);
-#else
-  return CDAFR_Vorbis_Open(fp);
+  CDAFR_MPC_Open,
 #endif
+  CDAFR_Vorbis_Open,
+ };
+
+ for(unsigned i = 0; i < sizeof(OpenFuncs) / sizeof(OpenFuncs[0]); i++)
+ {
+  try
+  {
+   fp->seek(0, SEEK_SET);
+   return CDAFR_Cache_Open(OpenFuncs[i](fp));
+  }
+  catch(int)
+  {
+
+  }
+ }
+
+ return(NULL);
 }
 
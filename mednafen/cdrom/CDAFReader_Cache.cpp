@@ -0,0 +1,263 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAFReader_Cache.cpp:
+**  Copyright (C) 2010-2016 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <mednafen/mednafen.h>
+#include "CDAFReader.h"
+#include "CDAFReader_Cache.h"
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <algorithm>
+#include <vector>
+
+// Frames decoded per lock hold on the background thread; bounds how long a cache miss can stall the reader.
+#define CACHE_DECODE_CHUNK (588 * 4)
+
+// A read this close ahead of the decoder waits for it instead of seeking the decoder away(one second of audio).
+#define CACHE_WAIT_WINDOW 44100
+
+class CDAFReader_Cache;
+
+// Bytes of PCM currently reserved by all open caches.
+static uint64_t CacheBytesInUse = 0;
+
+// One decoder thread serves every open cache, so a disc with dozens of compressed tracks doesn't start dozens of
+// decoders at load time.  It fills the track most recently read from first, then the rest in the order they were opened.
+// Everything below, and each cache's decoding state, is protected by CacheLock; the thread owns each cache's "inner"
+// except while a cache miss holds the lock.
+static slock_t *CacheLock = NULL;
+static scond_t *CacheCond = NULL;
+static sthread_t *CacheThread = NULL;
+static bool CacheThreadExit = false;
+static std::vector<CDAFReader_Cache *> Caches;
+static CDAFReader_Cache *CachePriority = NULL;
+
+class CDAFReader_Cache : public CDAFReader
+{
+   public:
+      CDAFReader_Cache(CDAFReader *arg_inner, uint64_t arg_cache_frames);
+      ~CDAFReader_Cache();
+
+      uint64_t Read_(int16_t *buffer, uint64_t frames);
+      bool Seek_(uint64_t frame_offset);
+      uint64_t FrameCount(void);
+
+   private:
+      static void DecodeThreadMain(void *data);
+      static CDAFReader_Cache *NextToDecode(void);
+      void DecodeChunk(void);
+
+      CDAFReader *inner;
+      uint64_t total_frames;
+
+      int16_t *cache;
+      uint64_t cache_bytes;
+      uint64_t cache_frames;
+
+      uint64_t read_pos;
+
+      uint64_t decoded_frames;
+};
+
+CDAFReader_Cache::CDAFReader_Cache(CDAFReader *arg_inner, uint64_t arg_cache_frames) : inner(arg_inner), cache(NULL), cache_frames(arg_cache_frames), read_pos(0),
+                                                                                          decoded_frames(0)
+{
+   total_frames = inner->FrameCount();
+   cache_bytes = cache_frames * 2 * sizeof(int16_t);
+
+   if(!(cache = (int16_t *)malloc(cache_bytes)))
+      throw(0);
+
+   if(!CacheThread)
+   {
+      CacheLock = slock_new();
+      CacheCond = scond_new();
+      CacheThreadExit = false;
+
+      if(!CacheLock || !CacheCond || !(CacheThread = sthread_create(DecodeThreadMain, NULL)))
+      {
+         if(CacheCond)
+            scond_free(CacheCond);
+
+         if(CacheLock)
+            slock_free(CacheLock);
+
+         CacheCond = NULL;
+         CacheLock = NULL;
+         free(cache);
+         throw(0);
+      }
+   }
+
+   slock_lock(CacheLock);
+   Caches.push_back(this);
+   scond_broadcast(CacheCond);
+   slock_unlock(CacheLock);
+
+   CacheBytesInUse += cache_bytes;
+}
+
+CDAFReader_Cache::~CDAFReader_Cache()
+{
+   bool last;
+
+   slock_lock(CacheLock);
+   Caches.erase(std::find(Caches.begin(), Caches.end(), this));
+
+   if(CachePriority == this)
+      CachePriority = NULL;
+
+   if((last = Caches.empty()))
+   {
+      CacheThreadExit = true;
+      scond_broadcast(CacheCond);
+   }
+   slock_unlock(CacheLock);
+
+   if(last)
+   {
+      sthread_join(CacheThread);
+      scond_free(CacheCond);
+      slock_free(CacheLock);
+
+      CacheThread = NULL;
+      CacheCond = NULL;
+      CacheLock = NULL;
+   }
+
+   CacheBytesInUse -= cache_bytes;
+   free(cache);
+
+   delete inner;
+}
+
+CDAFReader_Cache *CDAFReader_Cache::NextToDecode(void)
+{
+   if(CachePriority && CachePriority->decoded_frames < CachePriority->cache_frames)
+      return(CachePriority);
+
+   for(size_t i = 0; i < Caches.size(); i++)
+   {
+      if(Caches[i]->decoded_frames < Caches[i]->cache_frames)
+         return(Caches[i]);
+   }
+
+   return(NULL);
+}
+
+void CDAFReader_Cache::DecodeThreadMain(void *data)
+{
+   slock_lock(CacheLock);
+
+   while(!CacheThreadExit)
+   {
+      CDAFReader_Cache *c = NextToDecode();
+
+      if(!c)
+      {
+         scond_wait(CacheCond, CacheLock);
+         continue;
+      }
+
+      c->DecodeChunk();
+      scond_broadcast(CacheCond);
+
+      // Give readers a chance at the lock between chunks.
+      slock_unlock(CacheLock);
+      slock_lock(CacheLock);
+   }
+
+   slock_unlock(CacheLock);
+}
+
+void CDAFReader_Cache::DecodeChunk(void)
+{
+   const uint64_t pos = decoded_frames;
+   const uint64_t count = std::min<uint64_t>(CACHE_DECODE_CHUNK, cache_frames - pos);
+   const uint64_t got = inner->Read(pos, cache + pos * 2, count);
+
+   decoded_frames += got;
+
+   // Short read; the decoder disagrees with FrameCount(), so stop and let the rest be served uncached.
+   if(got < count)
+      cache_frames = decoded_frames;
+}
+
+uint64_t CDAFReader_Cache::Read_(int16_t *buffer, uint64_t frames)
+{
+   uint64_t ret;
+
+   slock_lock(CacheLock);
+
+   CachePriority = this;
+
+   while((read_pos + frames) > decoded_frames && (read_pos + frames) <= cache_frames && read_pos <= (decoded_frames + CACHE_WAIT_WINDOW))
+      scond_wait(CacheCond, CacheLock);
+
+   if((read_pos + frames) <= decoded_frames)
+   {
+      memcpy(buffer, cache + read_pos * 2, frames * 2 * sizeof(int16_t));
+      ret = frames;
+   }
+   else
+      ret = inner->Read(read_pos, buffer, frames);
+
+   slock_unlock(CacheLock);
+
+   read_pos += ret;
+
+   return(ret);
+}
+
+bool CDAFReader_Cache::Seek_(uint64_t frame_offset)
+{
+   read_pos = frame_offset;
+   return(true);
+}
+
+uint64_t CDAFReader_Cache::FrameCount(void)
+{
+   return(total_frames);
+}
+
+CDAFReader* CDAFR_Cache_Open(CDAFReader* inner)
+{
+   const uint64_t budget = (uint64_t)MDFN_GetSettingUI("pcfx.cdda_cache_size") << 20;
+   const uint64_t cache_frames = std::min<uint64_t>(inner->FrameCount(), (budget - std::min<uint64_t>(budget, CacheBytesInUse)) / (2 * sizeof(int16_t)));
+
+   if(!cache_frames)
+      return(inner);
+
+   try
+   {
+      return new CDAFReader_Cache(inner, cache_frames);
+   }
+   catch(...)
+   {
+      return(inner);
+   }
+}
+#else
+CDAFReader* CDAFR_Cache_Open(CDAFReader* inner)
+{
+   return(inner);
+}
+#endif
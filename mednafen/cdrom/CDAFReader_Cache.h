@@ -0,0 +1,30 @@
+/******************************************************************************/
+/* Mednafen - Multi-system Emulator                                           */
+/******************************************************************************/
+/* CDAFReader_Cache.h:
+**  Copyright (C) 2010-2016 Mednafen Team
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software Foundation, Inc.,
+** 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef __MDFN_CDAFREADER_CACHE_H
+#define __MDFN_CDAFREADER_CACHE_H
+
+// Wraps "inner"(taking ownership of it) in a reader that decodes the track into memory, up to the "pcfx.cdda_cache_size"
+// budget shared by all open tracks.  A single background thread decodes for all of them, the track last read from first.
+// Returns "inner" unchanged if there is no budget left or threads aren't available.
+CDAFReader* CDAFR_Cache_Open(CDAFReader* inner);
+
+#endif
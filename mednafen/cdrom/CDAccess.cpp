@@ -16,7 +16,11 @@
  */
 
 #include "../mednafen.h"
+#include "../FileStream.h"
+#include "../MemoryStream.h"
+#include "../MappedFileStream.h"
 #include "CDAccess.h"
+#include "CDAccess_BlockCache.h"
 #include "CDAccess_Image.h"
 #include "CDAccess_CCD.h"
 #ifdef HAVE_PBP
@@ -36,6 +40,33 @@ CDAccess::~CDAccess()
 
 }
 
+void CDAccess::HintReadSectors(int32_t lba, uint32_t count)
+{
+
+}
+
+bool CDAccess::GetCacheStats(CacheStats *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+
+   return false;
+}
+
+Stream *CDAccess_OpenImageStream(const std::string& path, bool image_memcache)
+{
+   Stream *ret = MappedFileStream::Open(path.c_str(), image_memcache);
+
+   if(ret)
+      return ret;
+
+   ret = new FileStream(path.c_str(), MODE_READ);
+
+   if(image_memcache)
+      ret = new MemoryStream(ret);
+
+   return ret;
+}
+
 CDAccess* CDAccess_Open(const std::string& path, bool image_memcache)
 {
    CDAccess *ret = NULL;
@@ -53,6 +84,9 @@ CDAccess* CDAccess_Open(const std::string& path, bool image_memcache)
    else
       ret = new CDAccess_Image(path, image_memcache);
 
+   if(!image_memcache)
+      ret = CDAccess_BlockCache_Open(ret);
+
    return ret;
 }
 
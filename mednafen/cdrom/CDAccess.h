@@ -5,6 +5,8 @@
 
 #include "CDUtility.h"
 
+class Stream;
+
 class CDAccess
 {
  public:
@@ -12,7 +14,11 @@ class CDAccess
  CDAccess();
  virtual ~CDAccess();
 
- virtual bool Read_Raw_Sector(uint8_t *buf, int32_t lba) = 0;
+ // If "synth" is non-NULL, sectors whose mode 1 user data is all the image stores(e.g. 2048-byte
+ // sector tracks) are returned with only the sync pattern and header filled in, and *synth is set
+ // to true; their EDC and L-EC fields can be generated with encode_mode1_sector() if needed.
+ // *synth is left untouched otherwise.
+ virtual bool Read_Raw_Sector(uint8_t *buf, int32_t lba, bool *synth) = 0;
 
  // Returns false if the read wouldn't be "fast"(i.e. reading from a disk),
  // or if the read can't be done in a thread-safe re-entrant manner.
@@ -22,6 +28,22 @@ class CDAccess
 
  virtual bool Read_TOC(TOC *toc) = 0;
 
+ // Hints that "count" sectors from "lba" on are about to be read, in order(see Stream::prefetch()).
+ // Must be thread-safe; it may be called while another thread is in Read_Raw_Sector().
+ virtual void HintReadSectors(int32_t lba, uint32_t count);
+
+ struct CacheStats
+ {
+  uint32_t entries;	// Decompressed units(e.g. CHD hunks) the cache holds.
+  uint64_t hits;	// Reads served from the cache, including ones that waited on a prefetch.
+  uint64_t misses;	// Reads that had to decompress on the reading thread.
+  uint64_t prefetched;	// Units decompressed ahead of time on the prefetch thread.
+  uint64_t decompress_us;	// Time spent decompressing, on either thread.
+ };
+
+ // Returns false if the image format has no decompression cache.  Must be thread-safe.
+ virtual bool GetCacheStats(CacheStats *stats);
+
  private:
  CDAccess(const CDAccess&);	// No copy constructor.
  CDAccess& operator=(const CDAccess&); // No assignment operator.
@@ -29,4 +51,8 @@ class CDAccess
 
 CDAccess* CDAccess_Open(const std::string& path, bool image_memcache);
 
+// Opens a disc image data file: memory-mapped where possible(read in up front if "image_memcache"
+// is set), otherwise as a FileStream, copied into a MemoryStream if "image_memcache" is set.
+Stream *CDAccess_OpenImageStream(const std::string& path, bool image_memcache);
+
 #endif
@@ -0,0 +1,343 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "../mednafen.h"
+#include "CDAccess_BlockCache.h"
+
+#include <list>
+#include <map>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+// Sectors per block; a block is allocated whole, but its sectors are only read in as they're asked for.
+#define BLOCK_SECTORS 16
+
+#define SECTOR_BYTES (2352 + 96)
+
+// LBAs from -150 to the end of the longest possible disc.
+#define LBA_FIRST (-150)
+#define LBA_END 449850
+
+class CDAccess_BlockCache;
+
+struct CacheBlock
+{
+ const CDAccess_BlockCache *owner;
+ uint32_t index;
+ uint16_t valid;	// Bit n set if sector n has been read in.
+ uint16_t synth;	// Bit n set if sector n is a mode 1 sector without EDC and L-EC(see CDAccess::Read_Raw_Sector()).
+ bool is_protected;
+ std::list<CacheBlock *>::iterator lru_pos;
+ uint8_t data[BLOCK_SECTORS][SECTOR_BYTES];
+};
+
+typedef std::pair<const CDAccess_BlockCache *, uint32_t> BlockKey;
+
+// Segmented LRU shared by all open discs: blocks start out on the probation list, and move to the protected list
+// when a sector already in them is read again.  Eviction takes from the probation list first, so a long run read
+// once(e.g. FMV) can't push out the boot and directory areas; the protected list is capped at 3/4 of the budget,
+// its least recently used blocks falling back to probation.  Front of each list is the most recently used.
+static std::map<BlockKey, CacheBlock *> BlockIndex;
+static std::list<CacheBlock *> Probation;
+static std::list<CacheBlock *> Protected;
+static size_t MaxBlocks = 0;
+static unsigned OpenCount = 0;
+static CDAccess_BlockCacheStats Stats;
+
+#ifdef HAVE_THREADS
+// Each disc may be read on its own thread.
+static slock_t *CacheLock = NULL;
+#endif
+
+static INLINE void LockCache(void)
+{
+#ifdef HAVE_THREADS
+ slock_lock(CacheLock);
+#endif
+}
+
+static INLINE void UnlockCache(void)
+{
+#ifdef HAVE_THREADS
+ slock_unlock(CacheLock);
+#endif
+}
+
+static void UnlinkBlock(CacheBlock *b)
+{
+ if(b->is_protected)
+  Protected.erase(b->lru_pos);
+ else
+  Probation.erase(b->lru_pos);
+}
+
+static void LinkBlock(CacheBlock *b, bool is_protected)
+{
+ b->is_protected = is_protected;
+
+ if(is_protected)
+ {
+  Protected.push_front(b);
+  b->lru_pos = Protected.begin();
+
+  if(Protected.size() > (MaxBlocks * 3 / 4))
+  {
+   CacheBlock *demoted = Protected.back();
+
+   Protected.pop_back();
+   demoted->is_protected = false;
+   Probation.push_front(demoted);
+   demoted->lru_pos = Probation.begin();
+  }
+ }
+ else
+ {
+  Probation.push_front(b);
+  b->lru_pos = Probation.begin();
+ }
+}
+
+// Returns a block to reuse, or NULL if the cache is below budget.
+static CacheBlock *EvictBlock(void)
+{
+ CacheBlock *ret = NULL;
+
+ while(BlockIndex.size() >= MaxBlocks && BlockIndex.size())
+ {
+  CacheBlock *victim = Probation.size() ? Probation.back() : Protected.back();
+
+  UnlinkBlock(victim);
+  BlockIndex.erase(BlockKey(victim->owner, victim->index));
+  Stats.evictions++;
+
+  free(ret);
+  ret = victim;
+ }
+
+ return ret;
+}
+
+class CDAccess_BlockCache : public CDAccess
+{
+ public:
+
+ CDAccess_BlockCache(CDAccess *arg_inner);
+ virtual ~CDAccess_BlockCache();
+
+ virtual bool Read_Raw_Sector(uint8_t *buf, int32_t lba, bool *synth);
+ virtual bool Fast_Read_Raw_PW_TSRE(uint8_t* pwbuf, int32_t lba);
+ virtual bool Read_TOC(TOC *toc);
+ virtual void HintReadSectors(int32_t lba, uint32_t count);
+ virtual bool GetCacheStats(CacheStats *stats);
+
+ private:
+
+ void StoreSector(uint32_t index, unsigned sub, const uint8_t *buf, bool synth);
+
+ CDAccess *inner;
+};
+
+CDAccess_BlockCache::CDAccess_BlockCache(CDAccess *arg_inner) : inner(arg_inner)
+{
+ if(!OpenCount)
+ {
+#ifdef HAVE_THREADS
+  if(!(CacheLock = slock_new()))
+   throw(0);
+#endif
+  memset(&Stats, 0, sizeof(Stats));
+ }
+
+ OpenCount++;
+}
+
+CDAccess_BlockCache::~CDAccess_BlockCache()
+{
+ std::map<BlockKey, CacheBlock *>::iterator it;
+
+ // Other discs may still be reading.
+ LockCache();
+ it = BlockIndex.lower_bound(BlockKey(this, 0));
+
+ while(it != BlockIndex.end() && it->first.first == this)
+ {
+  UnlinkBlock(it->second);
+  free(it->second);
+  BlockIndex.erase(it++);
+ }
+ UnlockCache();
+
+ if(!--OpenCount)
+ {
+#ifdef HAVE_THREADS
+  slock_free(CacheLock);
+  CacheLock = NULL;
+#endif
+ }
+
+ delete inner;
+}
+
+void CDAccess_BlockCache::StoreSector(uint32_t index, unsigned sub, const uint8_t *buf, bool synth)
+{
+ std::map<BlockKey, CacheBlock *>::iterator it = BlockIndex.find(BlockKey(this, index));
+ CacheBlock *b;
+
+ if(it != BlockIndex.end())
+ {
+  b = it->second;
+  UnlinkBlock(b);
+  LinkBlock(b, b->is_protected);
+ }
+ else
+ {
+  if(!(b = EvictBlock()) && !(b = (CacheBlock *)malloc(sizeof(CacheBlock))))
+   return;
+
+  b->owner = this;
+  b->index = index;
+  b->valid = 0;
+  b->synth = 0;
+  BlockIndex[BlockKey(this, index)] = b;
+  LinkBlock(b, false);
+ }
+
+ memcpy(b->data[sub], buf, SECTOR_BYTES);
+ b->valid |= 1U << sub;
+
+ if(synth)
+  b->synth |= 1U << sub;
+ else
+  b->synth &= ~(1U << sub);
+}
+
+bool CDAccess_BlockCache::Read_Raw_Sector(uint8_t *buf, int32_t lba, bool *synth)
+{
+ bool sector_synth = false;
+
+ if(lba < LBA_FIRST || lba >= LBA_END)
+  return inner->Read_Raw_Sector(buf, lba, synth);
+
+ const uint32_t index = (lba - LBA_FIRST) / BLOCK_SECTORS;
+ const unsigned sub = (lba - LBA_FIRST) % BLOCK_SECTORS;
+ bool hit = false;
+
+ LockCache();
+ {
+  std::map<BlockKey, CacheBlock *>::iterator it = BlockIndex.find(BlockKey(this, index));
+
+  if(it != BlockIndex.end() && (it->second->valid & (1U << sub)))
+  {
+   CacheBlock *b = it->second;
+
+   memcpy(buf, b->data[sub], SECTOR_BYTES);
+   sector_synth = (b->synth >> sub) & 1;
+
+   UnlinkBlock(b);
+   LinkBlock(b, true);
+   Stats.hits++;
+   hit = true;
+  }
+  else
+   Stats.misses++;
+ }
+ UnlockCache();
+
+ if(!hit)
+ {
+  // Read with the cache unlocked, so other discs aren't held up by this one's storage.
+  if(!inner->Read_Raw_Sector(buf, lba, &sector_synth))
+   return false;
+
+  LockCache();
+  StoreSector(index, sub, buf, sector_synth);
+  UnlockCache();
+ }
+
+ if(sector_synth)
+ {
+  if(synth)
+   *synth = true;
+  else
+   encode_mode1_sector(lba + 150, buf);
+ }
+
+ return true;
+}
+
+bool CDAccess_BlockCache::Fast_Read_Raw_PW_TSRE(uint8_t* pwbuf, int32_t lba)
+{
+ return inner->Fast_Read_Raw_PW_TSRE(pwbuf, lba);
+}
+
+bool CDAccess_BlockCache::Read_TOC(TOC *toc)
+{
+ return inner->Read_TOC(toc);
+}
+
+void CDAccess_BlockCache::HintReadSectors(int32_t lba, uint32_t count)
+{
+ inner->HintReadSectors(lba, count);
+}
+
+bool CDAccess_BlockCache::GetCacheStats(CacheStats *stats)
+{
+ return inner->GetCacheStats(stats);
+}
+
+CDAccess *CDAccess_BlockCache_Open(CDAccess *inner)
+{
+ const uint64_t budget = (uint64_t)MDFN_GetSettingUI("pcfx.cd_block_cache_size") << 20;
+
+ if(budget < sizeof(CacheBlock))
+  return inner;
+
+ try
+ {
+  CDAccess *ret = new CDAccess_BlockCache(inner);
+
+  // Discs are opened on the main thread before any of them is read from, but the budget may have changed
+  // since an earlier one was; the next store trims the cache down to it.
+  LockCache();
+  MaxBlocks = budget / sizeof(CacheBlock);
+  Stats.budget_bytes = budget;
+  UnlockCache();
+
+  return ret;
+ }
+ catch(...)
+ {
+  return inner;
+ }
+}
+
+bool CDAccess_BlockCache_GetStats(CDAccess_BlockCacheStats *stats)
+{
+ if(!OpenCount)
+  return false;
+
+ LockCache();
+ *stats = Stats;
+ stats->used_bytes = (uint64_t)BlockIndex.size() * sizeof(CacheBlock);
+ stats->blocks = BlockIndex.size();
+ stats->protected_blocks = Protected.size();
+ UnlockCache();
+
+ return true;
+}
@@ -0,0 +1,43 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef __MDFN_CDACCESS_BLOCKCACHE_H
+#define __MDFN_CDACCESS_BLOCKCACHE_H
+
+#include "CDAccess.h"
+
+// Wraps "inner"(taking ownership of it) in a CDAccess that keeps the sectors read from it in memory, in blocks of
+// consecutive sectors, up to the "pcfx.cd_block_cache_size" budget shared by all open discs.  Blocks read more than
+// once(boot files, directories, replayed FMV) are kept in preference to ones only read once.  Returns "inner"
+// unchanged if the budget is 0.
+CDAccess *CDAccess_BlockCache_Open(CDAccess *inner);
+
+struct CDAccess_BlockCacheStats
+{
+ uint64_t budget_bytes;
+ uint64_t used_bytes;
+ uint32_t blocks;		// Blocks held, of which...
+ uint32_t protected_blocks;	// ...have been read again since they were cached.
+ uint64_t hits;
+ uint64_t misses;
+ uint64_t evictions;
+};
+
+// Returns false if no open disc uses the cache.  Counters cover all discs opened since the cache was last unused.
+bool CDAccess_BlockCache_GetStats(CDAccess_BlockCacheStats *stats);
+
+#endif
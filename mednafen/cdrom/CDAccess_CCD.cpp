@@ -28,6 +28,7 @@
 #include <limits>
 #include <limits.h>
 #include <map>
+#include <algorithm>
 
 static void MDFN_strtoupper(std::string &str)
 {
@@ -83,7 +84,7 @@ static T CCD_ReadInt(CCD_Section &s, const std::string &propname, const bool hav
 }
 
 
-CDAccess_CCD::CDAccess_CCD(const std::string& path, bool image_memcache) : img_numsectors(0)
+CDAccess_CCD::CDAccess_CCD(const std::string& path, bool image_memcache) : img_stream(NULL), sub_stream(NULL), sub_buf(NULL), sub_data(NULL), img_numsectors(0)
 {
    Load(path, image_memcache);
 }
@@ -263,10 +264,7 @@ bool CDAccess_CCD::Load(const std::string& path, bool image_memcache)
    {
       std::string image_path = MDFN_EvalFIP(dir_path, file_base + std::string(".") + std::string(img_extsd), true);
 
-      if(image_memcache)
-         img_stream = new MemoryStream(new FileStream(image_path.c_str(), MODE_READ));
-      else
-         img_stream = new FileStream(image_path.c_str(), MODE_READ);
+      img_stream = CDAccess_OpenImageStream(image_path, image_memcache);
 
       uint64 ss = img_stream->size();
 
@@ -288,16 +286,33 @@ bool CDAccess_CCD::Load(const std::string& path, bool image_memcache)
    // Open subchannel stream
    {
       std::string sub_path = MDFN_EvalFIP(dir_path, file_base + std::string(".") + std::string(sub_extsd), true);
-      FileStream sub_stream(sub_path.c_str(), MODE_READ);
 
-      if(sub_stream.size() != (uint64)img_numsectors * 96)
+      sub_stream = MappedFileStream::Open(sub_path.c_str(), image_memcache);
+
+      if(sub_stream)
       {
-         log_cb(RETRO_LOG_ERROR, "CCD SUB file size mismatch.\n");
-         return false;
+         if(sub_stream->size() != (uint64)img_numsectors * 96)
+         {
+            log_cb(RETRO_LOG_ERROR, "CCD SUB file size mismatch.\n");
+            return false;
+         }
+
+         sub_data = sub_stream->map();
       }
+      else
+      {
+         FileStream sub_fs(sub_path.c_str(), MODE_READ);
 
-      sub_data = new uint8_t[(uint64)img_numsectors * 96];
-      sub_stream.read(sub_data, (uint64)img_numsectors * 96);
+         if(sub_fs.size() != (uint64)img_numsectors * 96)
+         {
+            log_cb(RETRO_LOG_ERROR, "CCD SUB file size mismatch.\n");
+            return false;
+         }
+
+         sub_buf = new uint8_t[(uint64)img_numsectors * 96];
+         sub_fs.read(sub_buf, (uint64)img_numsectors * 96);
+         sub_data = sub_buf;
+      }
    }
 
    CheckSubQSanity();
@@ -396,12 +411,14 @@ bool CDAccess_CCD::CheckSubQSanity(void)
 CDAccess_CCD::~CDAccess_CCD()
 {
    if (img_stream)
-      delete[] img_stream;
-   if (sub_data)
-      delete[] sub_data;
+      delete img_stream;
+   if (sub_stream)
+      delete sub_stream;
+   if (sub_buf)
+      delete[] sub_buf;
 }
 
-bool CDAccess_CCD::Read_Raw_Sector(uint8_t *buf, int32_t lba)
+bool CDAccess_CCD::Read_Raw_Sector(uint8_t *buf, int32_t lba, bool *synth)
 {
    if(lba < 0)
    {
@@ -423,6 +440,16 @@ bool CDAccess_CCD::Read_Raw_Sector(uint8_t *buf, int32_t lba)
    return true;
 }
 
+void CDAccess_CCD::HintReadSectors(int32 lba, uint32 count)
+{
+   if(lba < 0 || (size_t)lba >= img_numsectors)
+      return;
+
+   count = std::min<uint64>(count, img_numsectors - lba);
+
+   img_stream->prefetch((uint64)lba * 2352, (uint64)count * 2352);
+}
+
 bool CDAccess_CCD::Fast_Read_Raw_PW_TSRE(uint8_t* pwbuf, int32_t lba)
 {
    if(lba < 0)
@@ -21,6 +21,7 @@
 
 #include <mednafen/FileStream.h>
 #include <mednafen/MemoryStream.h>
+#include <mednafen/MappedFileStream.h>
 
 #include "CDAccess.h"
 
@@ -31,12 +32,14 @@ class CDAccess_CCD : public CDAccess
  CDAccess_CCD(const std::string& path, bool image_memcache);
  virtual ~CDAccess_CCD();
 
- virtual bool Read_Raw_Sector(uint8 *buf, int32 lba);
+ virtual bool Read_Raw_Sector(uint8 *buf, int32 lba, bool *synth);
 
  virtual bool Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba);
 
  virtual bool Read_TOC(TOC *toc);
 
+ virtual void HintReadSectors(int32 lba, uint32 count);
+
  private:
 
  bool Load(const std::string& path, bool image_memcache);
@@ -45,7 +48,9 @@ class CDAccess_CCD : public CDAccess
  bool CheckSubQSanity(void);
 
  Stream *img_stream;
- uint8_t *sub_data;
+ MappedFileStream *sub_stream;	// NULL if the .sub file couldn't be mapped, and was read into sub_buf instead.
+ uint8_t *sub_buf;
+ const uint8_t *sub_data;
 
  size_t img_numsectors;
  TOC tocd;
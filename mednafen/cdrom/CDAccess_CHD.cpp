@@ -21,6 +21,18 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <chrono>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
 #include <mednafen/mednafen.h>
 #include <mednafen/general.h>
 #include <mednafen/mednafen-endian.h>
@@ -54,8 +66,21 @@ static const int32_t DI_Size_Table[8] =
         2352  // CD-I RAW
 };
 
-CDAccess_CHD::CDAccess_CHD(const std::string &path, bool image_memcache) : NumTracks(0), total_sectors(0)
+// Most memory the hunk cache may use, whatever "pcfx.chd_cache_hunks" says(it always gets at least 16 hunks).
+static const uint32_t HunkCacheMaxBytes = 32 << 20;
+
+CDAccess_CHD::CDAccess_CHD(const std::string &path, bool image_memcache) : NumTracks(0), total_sectors(0), chd(NULL),
+                                                                          hunk_bytes(0), total_hunks(0), hunk_cache_size(0), hunk_mem(NULL), hunk_entries(NULL), prefetch_hunks(0),
+#ifdef HAVE_THREADS
+                                                                          prefetch_chd(NULL), prefetch_thread(NULL), hunk_lock(NULL), hunk_cond(NULL),
+                                                                          prefetch_start(0), prefetch_next(0), prefetch_end(0), hunk_threads_exit(false),
+#endif
+                                                                          disc_mem(NULL), disc_hunk_state(NULL), precache_next(0), precache_left(0)
+#ifdef HAVE_THREADS
+                                                                          , precache_threads_started(0)
+#endif
 {
+  memset(&hunk_stats, 0, sizeof(hunk_stats));
   Load(path, image_memcache);
 }
 
@@ -68,8 +93,19 @@ bool CDAccess_CHD::Load(const std::string &path, bool image_memcache)
      return false;
   }
 
-  if (image_memcache)
+  const chd_header *head = chd_get_header(chd);
+
+  hunk_bytes = head->hunkbytes;
+  total_hunks = head->totalhunks;
+
+#ifdef HAVE_THREADS
+  hunk_lock = slock_new();
+  hunk_cond = scond_new();
+#endif
+
+  if (image_memcache && !InitDiscCache(path))
   {
+     // Not enough memory for the decompressed disc; keep the compressed one in memory at least.
      err = chd_precache(chd);
 
      if (err != CHDERR_NONE)
@@ -79,12 +115,10 @@ bool CDAccess_CHD::Load(const std::string &path, bool image_memcache)
      }
   }
 
-  /* allocate storage for sector reads */
-  const chd_header *head = chd_get_header(chd);
-  hunkmem = (uint8_t *)malloc(head->hunkbytes);
-  oldhunk = -1;
+  if (!disc_mem)
+    InitHunkCache(path);
 
-  log_cb(RETRO_LOG_INFO, "chd_load '%s' hunkbytes=%d\n", path.c_str(), head->hunkbytes);
+  log_cb(RETRO_LOG_INFO, "chd_load '%s' hunkbytes=%d cache=%u prefetch=%u\n", path.c_str(), hunk_bytes, disc_mem ? total_hunks : hunk_cache_size, prefetch_hunks);
 
   int plba = -150;
   int numsectors = 0;
@@ -213,93 +247,555 @@ bool CDAccess_CHD::Load(const std::string &path, bool image_memcache)
     }
   }
 
+  GenerateSubQRuns();
+
   return true;
 }
 
 CDAccess_CHD::~CDAccess_CHD()
 {
+  KillHunkCache();
+
   if (chd != NULL)
     chd_close(chd);
+}
 
-  if (hunkmem)
-    free(hunkmem);
+void CDAccess_CHD::InitHunkCache(const std::string &path)
+{
+  hunk_cache_size = std::max<uint32_t>(16, std::min<uint64_t>(MDFN_GetSettingUI("pcfx.chd_cache_hunks"), HunkCacheMaxBytes / hunk_bytes));
+  hunk_mem = (uint8_t *)malloc((size_t)hunk_cache_size * hunk_bytes);
+  hunk_entries = new HunkEntry[hunk_cache_size];
+
+  for (uint32_t i = 0; i < hunk_cache_size; i++)
+  {
+    hunk_entries[i].data = hunk_mem + (size_t)i * hunk_bytes;
+    HunkFree.push_back(&hunk_entries[i]);
+  }
+
+  last_hunk = ~0U;
+
+#ifdef HAVE_THREADS
+  // Prefetching more than half of the cache would evict hunks before they're read.
+  prefetch_hunks = std::min<uint32_t>(MDFN_GetSettingUI("pcfx.chd_prefetch_hunks"), hunk_cache_size / 2);
+
+  if (prefetch_hunks)
+  {
+    if (chd_open(path.c_str(), CHD_OPEN_READ, NULL, &prefetch_chd) != CHDERR_NONE)
+      prefetch_chd = NULL;
+    else if (!(prefetch_thread = sthread_create(PrefetchThreadStart, this)))
+    {
+      chd_close(prefetch_chd);
+      prefetch_chd = NULL;
+    }
+
+    if (!prefetch_chd)
+    {
+      log_cb(RETRO_LOG_WARN, "CHD prefetch unavailable: %s\n", path.c_str());
+      prefetch_hunks = 0;
+    }
+  }
+#endif
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+// Number of processors available, for sizing thread pools.
+static unsigned GetCPUCount(void)
 {
-  const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
+#if defined(_WIN32)
+  SYSTEM_INFO si;
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  GetSystemInfo(&si);
+
+  return std::max<unsigned>(1, si.dwNumberOfProcessors);
+#elif defined(_SC_NPROCESSORS_ONLN)
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return (n > 0) ? n : 1;
+#else
+  return 1;
+#endif
+}
+
+bool CDAccess_CHD::InitDiscCache(const std::string &path)
+{
+  const uint64_t disc_bytes = (uint64_t)total_hunks * hunk_bytes;
+
+  if (disc_bytes > (size_t)-1 || !(disc_mem = (uint8_t *)malloc(disc_bytes)))
+    return false;
+
+  disc_hunk_state = (uint8_t *)calloc(total_hunks, 1);
+  precache_left = total_hunks;
+  precache_start_time = std::chrono::steady_clock::now();
+
+#ifdef HAVE_THREADS
+  // One processor is left for the emulation itself, which has to be able to run meanwhile.
+  const unsigned num_threads = std::min<unsigned>(8, std::max<unsigned>(1, GetCPUCount() - 1));
+
+  for (unsigned i = 0; i < num_threads; i++)
   {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-      log_cb(RETRO_LOG_ERROR, "chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    chd_file *cf;
+
+    if (chd_open(path.c_str(), CHD_OPEN_READ, NULL, &cf) != CHDERR_NONE)
+      break;
+
+    precache_chds.push_back(cf);
+  }
+
+  for (unsigned i = 0; i < precache_chds.size(); i++)
+  {
+    sthread_t *thread = sthread_create(PrecacheThreadStart, this);
+
+    if (!thread)
+      break;
+
+    precache_threads.push_back(thread);
+  }
+
+  if (precache_threads.empty())
+    log_cb(RETRO_LOG_WARN, "CHD background decompression unavailable: %s\n", path.c_str());
+#endif
+
+  return true;
+}
+
+void CDAccess_CHD::KillHunkCache(void)
+{
+#ifdef HAVE_THREADS
+  if (prefetch_thread || !precache_threads.empty())
+  {
+    LockHunks();
+    hunk_threads_exit = true;
+    scond_broadcast(hunk_cond);
+    UnlockHunks();
+  }
+
+  if (prefetch_thread)
+  {
+    sthread_join(prefetch_thread);
+    prefetch_thread = NULL;
+  }
+
+  for (unsigned i = 0; i < precache_threads.size(); i++)
+    sthread_join(precache_threads[i]);
+  precache_threads.clear();
+
+  // Threads close theirs when done, and unstarted ones are still here.
+  for (unsigned i = 0; i < precache_chds.size(); i++)
+    if (precache_chds[i])
+      chd_close(precache_chds[i]);
+  precache_chds.clear();
+
+  if (prefetch_chd)
+  {
+    chd_close(prefetch_chd);
+    prefetch_chd = NULL;
+  }
+
+  if (hunk_cond)
+  {
+    scond_free(hunk_cond);
+    hunk_cond = NULL;
+  }
+
+  if (hunk_lock)
+  {
+    slock_free(hunk_lock);
+    hunk_lock = NULL;
+  }
+#endif
+
+  HunkLRU.clear();
+  HunkIndex.clear();
+  HunkFree.clear();
+
+  delete[] hunk_entries;
+  hunk_entries = NULL;
+
+  free(hunk_mem);
+  hunk_mem = NULL;
+
+  free(disc_hunk_state);
+  disc_hunk_state = NULL;
+
+  free(disc_mem);
+  disc_mem = NULL;
+}
+
+// Called with the hunk lock held; takes a free entry, or evicts the least recently used one.
+CDAccess_CHD::HunkEntry *CDAccess_CHD::AllocHunk(uint32_t hunknum)
+{
+  HunkEntry *he;
+
+  if (!HunkFree.empty())
+  {
+    he = HunkFree.back();
+    HunkFree.pop_back();
+  }
+  else
+  {
+    he = HunkLRU.back();
+    HunkLRU.pop_back();
+    HunkIndex.erase(he->hunknum);
   }
 
-  memcpy(buf, hunkmem + hunkofs * (2352 + 96), 2352);
+  he->hunknum = hunknum;
+  he->ready = false;
+  HunkIndex[hunknum] = he;
+
+  return he;
+}
+
+// Called with the hunk lock held, which is dropped while decompressing.  On failure, the entry is freed again.
+chd_error CDAccess_CHD::DecompressHunk(chd_file *cf, HunkEntry *he)
+{
+  chd_error err;
+
+  UnlockHunks();
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  err = chd_read(cf, he->hunknum, he->data);
+  const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+  LockHunks();
+
+  hunk_stats.decompress_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+  if (err != CHDERR_NONE)
+  {
+    HunkIndex.erase(he->hunknum);
+    HunkFree.push_back(he);
+  }
+  else
+  {
+    he->ready = true;
+    HunkLRU.push_front(he);
+    he->lru_pos = HunkLRU.begin();
+  }
+
+#ifdef HAVE_THREADS
+  scond_broadcast(hunk_cond);
+#endif
 
   return err;
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+chd_error CDAccess_CHD::ReadHunkData(uint8_t *buf, uint32_t hunknum, uint32_t offset, uint32_t len)
 {
-  const chd_header *head = chd_get_header(chd);
-  int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
-  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
-  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
+  std::map<uint32_t, HunkEntry*>::iterator it;
+  HunkEntry *he;
 
-  /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
+  if (disc_mem)
+    return ReadDiscHunkData(buf, hunknum, offset, len);
+
+  LockHunks();
+
+#ifdef HAVE_THREADS
+  // Wait for a prefetch of this hunk to finish rather than decompressing it a second time.
+  while ((it = HunkIndex.find(hunknum)) != HunkIndex.end() && !it->second->ready)
+    scond_wait(hunk_cond, hunk_lock);
+#endif
+
+  it = HunkIndex.find(hunknum);
+
+  if (it != HunkIndex.end())
+  {
+    he = it->second;
+    HunkLRU.splice(HunkLRU.begin(), HunkLRU, he->lru_pos);
+    hunk_stats.hits++;
+  }
+  else
+  {
+    chd_error err;
+
+    he = AllocHunk(hunknum);
+    hunk_stats.misses++;
+
+    if ((err = DecompressHunk(chd, he)) != CHDERR_NONE)
+    {
+      UnlockHunks();
+      log_cb(RETRO_LOG_ERROR, "chd_read failed hunk=%u error=%d\n", hunknum, err);
+      memset(buf, 0, len);
+      return err;
+    }
+  }
+
+  memcpy(buf, he->data + offset, len);
+
+  if (hunknum == last_hunk + 1)
+    Prefetch(hunknum + 1, prefetch_hunks);
+
+  last_hunk = hunknum;
+
+  UnlockHunks();
+
+  return CHDERR_NONE;
+}
+
+// Called with the hunk lock held once a read of hunk "hunknum" for disc_mem is over, "first_try" if it had been empty.
+void CDAccess_CHD::FinishDiscHunk(uint32_t hunknum, chd_error err, bool first_try)
+{
+  disc_hunk_state[hunknum] = (err == CHDERR_NONE) ? DISC_HUNK_READY : DISC_HUNK_FAILED;
+
+  if (first_try && !--precache_left)
   {
-    err = chd_read(chd, hunknum, hunkmem);
+    const std::chrono::steady_clock::duration t = std::chrono::steady_clock::now() - precache_start_time;
+
+    log_cb(RETRO_LOG_INFO, "CHD image decompressed in %u ms.\n", (unsigned)std::chrono::duration_cast<std::chrono::milliseconds>(t).count());
+  }
+
+#ifdef HAVE_THREADS
+  scond_broadcast(hunk_cond);
+#endif
+}
+
+chd_error CDAccess_CHD::ReadDiscHunkData(uint8_t *buf, uint32_t hunknum, uint32_t offset, uint32_t len)
+{
+  uint8_t *data = disc_mem + (size_t)hunknum * hunk_bytes;
+
+  LockHunks();
+
+#ifdef HAVE_THREADS
+  while (disc_hunk_state[hunknum] == DISC_HUNK_BUSY)
+    scond_wait(hunk_cond, hunk_lock);
+#endif
+
+  if (disc_hunk_state[hunknum] == DISC_HUNK_READY)
+    hunk_stats.hits++;
+  else
+  {
+    const bool first_try = (disc_hunk_state[hunknum] == DISC_HUNK_EMPTY);
+    chd_error err;
+
+    disc_hunk_state[hunknum] = DISC_HUNK_BUSY;
+    hunk_stats.misses++;
+
+    // Have the precache threads carry on from here, as this is where the game is reading.
+    if (first_try)
+      precache_next = hunknum + 1;
+
+    UnlockHunks();
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    err = chd_read(chd, hunknum, data);
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    LockHunks();
+    hunk_stats.decompress_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    FinishDiscHunk(hunknum, err, first_try);
+
     if (err != CHDERR_NONE)
-      log_cb(RETRO_LOG_ERROR, "chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
+    {
+      UnlockHunks();
+      log_cb(RETRO_LOG_ERROR, "chd_read failed hunk=%u error=%d\n", hunknum, err);
+      memset(buf, 0, len);
+      return err;
+    }
   }
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2048);
+  UnlockHunks();
 
-  return err;
+  // Ready hunks never change again, so they can be read from without the lock.
+  memcpy(buf, data + offset, len);
+
+  return CHDERR_NONE;
 }
 
-bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+#ifdef HAVE_THREADS
+void CDAccess_CHD::PrecacheThreadStart(void *data)
+{
+  ((CDAccess_CHD *)data)->PrecacheThreadMain();
+}
+
+void CDAccess_CHD::PrecacheThreadMain(void)
+{
+  LockHunks();
+
+  const uint32_t slot = precache_threads_started++;
+  chd_file *cf = precache_chds[slot];
+
+  while (!hunk_threads_exit && precache_left)
+  {
+    uint32_t hunknum = (precache_next < total_hunks) ? precache_next : 0;
+    uint32_t i;
+    chd_error err;
+
+    for (i = 0; i < total_hunks && disc_hunk_state[hunknum] != DISC_HUNK_EMPTY; i++)
+      hunknum = (hunknum + 1 < total_hunks) ? hunknum + 1 : 0;
+
+    // The rest are being decompressed by others.
+    if (i == total_hunks)
+      break;
+
+    disc_hunk_state[hunknum] = DISC_HUNK_BUSY;
+    precache_next = hunknum + 1;
+    UnlockHunks();
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    err = chd_read(cf, hunknum, disc_mem + (size_t)hunknum * hunk_bytes);
+    const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    LockHunks();
+    hunk_stats.decompress_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    if (err == CHDERR_NONE)
+      hunk_stats.prefetched++;
+
+    FinishDiscHunk(hunknum, err, true);
+  }
+
+  // Done with it; give back its buffers now rather than when the disc is closed.
+  precache_chds[slot] = NULL;
+  UnlockHunks();
+
+  chd_close(cf);
+}
+#endif
+
+// Returns the hunk holding sector "lba", or -1 if it isn't stored in the CHD(pregap, postgap, lead-out).
+int32_t CDAccess_CHD::LBAToHunk(int32_t lba) const
+{
+  const int32_t sph = hunk_bytes / (2352 + 96);
+
+  for (int32_t track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+  {
+    const CHDFILE_TRACK_INFO *ct = &Tracks[track];
+
+    if (lba >= ct->LBA && lba < (ct->LBA + ct->sectors))
+      return (lba - ct->LBA + ct->fileOffset) / sph;
+  }
+
+  return -1;
+}
+
+// Called with the hunk lock held; has hunks "hunknum" through "hunknum" + "count" - 1 decompressed ahead.
+void CDAccess_CHD::Prefetch(uint32_t hunknum, uint32_t count)
+{
+#ifdef HAVE_THREADS
+  if (!prefetch_thread || !count)
+    return;
+
+  const uint32_t end = std::min<uint32_t>(total_hunks, hunknum + std::min<uint32_t>(count, hunk_cache_size / 2));
+
+  if (hunknum >= prefetch_start && hunknum <= prefetch_end)
+  {
+    // Same run of reads; don't let the thread fall behind the reader.
+    prefetch_start = hunknum;
+
+    if (hunknum <= prefetch_next && end <= prefetch_end)
+      return;
+
+    prefetch_next = std::max(prefetch_next, hunknum);
+    prefetch_end = std::max(prefetch_end, end);
+  }
+  else
+  {
+    prefetch_start = prefetch_next = hunknum;
+    prefetch_end = end;
+  }
+
+  scond_broadcast(hunk_cond);
+#endif
+}
+
+#ifdef HAVE_THREADS
+void CDAccess_CHD::PrefetchThreadStart(void *data)
+{
+  ((CDAccess_CHD *)data)->PrefetchThreadMain();
+}
+
+void CDAccess_CHD::PrefetchThreadMain(void)
+{
+  LockHunks();
+
+  while (!hunk_threads_exit)
+  {
+    if (prefetch_next >= prefetch_end)
+    {
+      scond_wait(hunk_cond, hunk_lock);
+      continue;
+    }
+
+    const uint32_t hunknum = prefetch_next++;
+
+    if (HunkIndex.find(hunknum) != HunkIndex.end())
+      continue;
+
+    // Errors are left for the reader to run into and report.
+    if (DecompressHunk(prefetch_chd, AllocHunk(hunknum)) == CHDERR_NONE)
+      hunk_stats.prefetched++;
+  }
+
+  UnlockHunks();
+}
+#endif
+
+void CDAccess_CHD::HintReadSectors(int32_t lba, uint32_t count)
+{
+  if (disc_mem)
+  {
+    const int32_t first = LBAToHunk(lba);
+
+    // Decompress the disc from here on next.
+    LockHunks();
+    if (first >= 0 && disc_hunk_state[first] == DISC_HUNK_EMPTY)
+      precache_next = first;
+    UnlockHunks();
+    return;
+  }
+
+  if (!prefetch_hunks)
+    return;
+
+  const int32_t first = LBAToHunk(lba);
+  const int32_t sph = hunk_bytes / (2352 + 96);
+
+  if (first < 0)
+    return;
+
+  LockHunks();
+  Prefetch(first, (count + sph - 1) / sph + 1);
+  UnlockHunks();
+}
+
+bool CDAccess_CHD::GetCacheStats(CacheStats *stats)
+{
+  LockHunks();
+  *stats = hunk_stats;
+  stats->entries = disc_mem ? total_hunks : hunk_cache_size;
+  UnlockHunks();
+
+  return hunk_entries != NULL || disc_mem != NULL;
+}
+
+bool CDAccess_CHD::Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
 {
-  const chd_header *head = chd_get_header(chd);
   int cad = lba - track->LBA + track->fileOffset;
-  int sph = head->hunkbytes / (2352 + 96);
+  int sph = hunk_bytes / (2352 + 96);
   int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
   int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
-  int err = CHDERR_NONE;
-
   /* each hunk holds ~8 sectors, optimize when reading contiguous sectors */
-  if (hunknum != oldhunk)
-  {
-    err = chd_read(chd, hunknum, hunkmem);
-    if (err != CHDERR_NONE)
-      log_cb(RETRO_LOG_ERROR, "chd_read_sector failed lba=%d error=%d\n", lba, err);
-    else
-      oldhunk = hunknum;
-  }
+  return ReadHunkData(buf, hunknum, hunkofs * (2352 + 96), 2352) != CHDERR_NONE;
+}
 
-  memcpy(buf + 16, hunkmem + hunkofs * (2352 + 96), 2336);
+bool CDAccess_CHD::Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  int cad = lba - track->LBA + track->fileOffset;
+  int sph = hunk_bytes / (2352 + 96);
+  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
+  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
+  return ReadHunkData(buf + 16, hunknum, hunkofs * (2352 + 96), 2048) != CHDERR_NONE;
+}
 
-  return err;
+bool CDAccess_CHD::Read_CHD_Hunk_M2(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track)
+{
+  int cad = lba - track->LBA + track->fileOffset;
+  int sph = hunk_bytes / (2352 + 96);
+  int hunknum = cad / sph; //(cad * head->unitbytes) / head->hunkbytes;
+  int hunkofs = cad % sph; //(cad * head->unitbytes) % head->hunkbytes;
+  return ReadHunkData(buf + 16, hunknum, hunkofs * (2352 + 96), 2336) != CHDERR_NONE;
 }
 
-bool CDAccess_CHD::Read_Raw_Sector(uint8_t *buf, int32_t lba)
+bool CDAccess_CHD::Read_Raw_Sector(uint8_t *buf, int32_t lba, bool *synth)
 {
-  uint8_t SimuQ[0xC];
   int32_t track;
   CHDFILE_TRACK_INFO *ct;
 
@@ -335,7 +831,6 @@ bool CDAccess_CHD::Read_Raw_Sector(uint8_t *buf, int32_t lba)
 
   memset(buf + 2352, 0, 96);
   track = MakeSubPQ(lba, buf + 2352);
-  subq_deinterleave(buf + 2352, SimuQ);
 
   ct = &Tracks[track];
 
@@ -390,7 +885,13 @@ bool CDAccess_CHD::Read_Raw_Sector(uint8_t *buf, int32_t lba)
 
       case DI_FORMAT_MODE1:
         Read_CHD_Hunk_M1(buf, lba, ct);
-        encode_mode1_sector(lba + 150, buf);
+        if (synth)
+        {
+          encode_mode1_header(lba + 150, buf);
+          *synth = true;
+        }
+        else
+          encode_mode1_sector(lba + 150, buf);
         break;
 
       case DI_FORMAT_MODE1_RAW:
@@ -426,107 +927,105 @@ bool CDAccess_CHD::Read_Raw_Sector(uint8_t *buf, int32_t lba)
 }
 
 //
-// Note: this function makes use of the current contents(as in |=) in SubPWBuf.
+// Works out the Q subchannel runs for MakeSubPQ() from the track list; a run boundary can only be at the start or end
+// of a track's pregap, data, or postgap, at an index, or 150 sectors before a track's start.
 //
-int32_t CDAccess_CHD::MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const
+void CDAccess_CHD::GenerateSubQRuns(void)
 {
-  uint8_t buf[0xC];
-  int32_t track;
-  uint32_t lba_relative;
-  uint32_t ma, sa, fa;
-  uint32_t m, s, f;
-  uint8_t pause_or = 0x00;
-  bool track_found = false;
+  std::vector<int32_t> bounds;
 
-  for (track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+  for (int32_t track = FirstTrack; track < (FirstTrack + NumTracks); track++)
   {
-    if (lba >= (Tracks[track].LBA - Tracks[track].pregap_dv - Tracks[track].pregap) && lba < (Tracks[track].LBA + Tracks[track].sectors + Tracks[track].postgap))
-    {
-      track_found = true;
-      break;
-    }
-  }
+    const CHDFILE_TRACK_INFO *ct = &Tracks[track];
 
-  if (lba < Tracks[track].LBA)
-    lba_relative = Tracks[track].LBA - 1 - lba;
-  else
-    lba_relative = lba - Tracks[track].LBA;
+    bounds.push_back(ct->LBA - ct->pregap_dv - ct->pregap);
+    bounds.push_back(ct->LBA - 150);
+    bounds.push_back(ct->LBA);
+    bounds.push_back(ct->LBA + ct->sectors);
+    bounds.push_back(ct->LBA + ct->sectors + ct->postgap);
 
-  f = (lba_relative % 75);
-  s = ((lba_relative / 75) % 60);
-  m = (lba_relative / 75 / 60);
+    for (int32_t i = 0; i < 100; i++)
+      bounds.push_back(ct->index[i]);
+  }
 
-  fa = (lba + 150) % 75;
-  sa = ((lba + 150) / 75) % 60;
-  ma = ((lba + 150) / 75 / 60);
+  std::sort(bounds.begin(), bounds.end());
+  bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
 
-  uint8_t adr = 0x1; // Q channel data encodes position
-  uint8_t control = Tracks[track].subq_control;
+  SubQRuns.clear();
 
-  // Handle pause(D7 of interleaved subchannel byte) bit, should be set to 1 when in pregap or postgap.
-  if ((lba < Tracks[track].LBA) || (lba >= Tracks[track].LBA + Tracks[track].sectors))
+  for (size_t b = 0; b < bounds.size(); b++)
   {
-    //printf("pause_or = 0x80 --- %d\n", lba);
-    pause_or = 0x80;
-  }
+    const int32_t lba = bounds[b];
+    SubQRun run;
 
-  // Handle pregap between audio->data track
-  {
-    int32_t pg_offset = (int32_t)lba - Tracks[track].LBA;
+    memset(&run, 0, sizeof(run));
+    run.lba = lba;
 
-    // If we're more than 2 seconds(150 sectors) from the real "start" of the track/INDEX 01, and the track is a data track,
-    // and the preceding track is an audio track, encode it as audio(by taking the SubQ control field from the preceding track).
-    //
-    // TODO: Look into how we're supposed to handle subq control field in the four combinations of track types(data/audio).
-    //
-    if (pg_offset < -150)
+    for (int32_t track = FirstTrack; track < (FirstTrack + NumTracks); track++)
     {
-      if ((Tracks[track].subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+      if (lba >= (Tracks[track].LBA - Tracks[track].pregap_dv - Tracks[track].pregap) && lba < (Tracks[track].LBA + Tracks[track].sectors + Tracks[track].postgap))
       {
-        //printf("Pregap part 1 audio->data: lba=%d track_lba=%d\n", lba, Tracks[track].LBA);
-        control = Tracks[track - 1].subq_control;
+        run.track = track;
+        run.track_lba = Tracks[track].LBA;
+        run.control = Tracks[track].subq_control;
+
+        // Handle pause(D7 of interleaved subchannel byte) bit, should be set to 1 when in pregap or postgap.
+        if ((lba < Tracks[track].LBA) || (lba >= Tracks[track].LBA + Tracks[track].sectors))
+          run.pause = 0x80;
+
+        // If we're more than 2 seconds(150 sectors) from the real "start" of the track/INDEX 01, and the track is a data track,
+        // and the preceding track is an audio track, encode it as audio(by taking the SubQ control field from the preceding track).
+        //
+        // TODO: Look into how we're supposed to handle subq control field in the four combinations of track types(data/audio).
+        //
+        if ((lba - Tracks[track].LBA) < -150)
+        {
+          if ((Tracks[track].subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+            run.control = Tracks[track - 1].subq_control;
+        }
+
+        for (int32_t i = 0; i < 100; i++)
+        {
+          if (lba >= Tracks[track].index[i])
+            run.index = i;
+        }
+        break;
       }
     }
-  }
-
-  memset(buf, 0, 0xC);
-  buf[0] = (adr << 0) | (control << 4);
-  buf[1] = U8_to_BCD(track);
 
-  // Index
-  //if(lba < Tracks[track].LBA) // Index is 00 in pregap
-  // buf[2] = U8_to_BCD(0x00);
-  //else
-  // buf[2] = U8_to_BCD(0x01);
-  {
-    int index = 0;
-
-    for (int32_t i = 0; i < 100; i++)
+    if (SubQRuns.size())
     {
-      if (lba >= Tracks[track].index[i])
-        index = i;
+      const SubQRun &prev = SubQRuns.back();
+
+      if (prev.track == run.track && prev.track_lba == run.track_lba && prev.index == run.index && prev.control == run.control && prev.pause == run.pause)
+        continue;
     }
-    buf[2] = U8_to_BCD(index);
-  }
 
-  // Track relative MSF address
-  buf[3] = U8_to_BCD(m);
-  buf[4] = U8_to_BCD(s);
-  buf[5] = U8_to_BCD(f);
+    SubQRuns.push_back(run);
+  }
+}
 
-  buf[6] = 0; // Zerroooo
+//
+// Note: this function makes use of the current contents(as in |=) in SubPWBuf.
+//
+int32_t CDAccess_CHD::MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const
+{
+  const SubQRun *run = subq_find_run(SubQRuns.data(), SubQRuns.size(), lba);
+  uint8_t buf[0xC];
 
-  // Absolute MSF address
-  buf[7] = U8_to_BCD(ma);
-  buf[8] = U8_to_BCD(sa);
-  buf[9] = U8_to_BCD(fa);
+  // Not in any track, which a valid image can't produce; carry on with the last track rather than fail the read.
+  for (size_t i = SubQRuns.size(); !run && i; i--)
+  {
+    if (SubQRuns[i - 1].track)
+      run = &SubQRuns[i - 1];
+  }
 
-  subq_generate_checksum(buf);
+  assert(run);
 
-  for (int i = 0; i < 96; i++)
-    SubPWBuf[i] |= (((buf[i >> 3] >> (7 - (i & 0x7))) & 1) ? 0x40 : 0x00) | pause_or;
+  subq_synth_run(*run, lba, buf);
+  subpq_interleave(buf, run->pause, SubPWBuf);
 
-  return track;
+  return run->track;
 }
 
 bool CDAccess_CHD::Fast_Read_Raw_PW_TSRE(uint8_t *pwbuf, int32_t lba)
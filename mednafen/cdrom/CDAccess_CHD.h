@@ -25,6 +25,15 @@
 #include "CDAccess.h"
 #include <libchdr/chd.h>
 
+#include <chrono>
+#include <list>
+#include <map>
+#include <vector>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 struct CHDFILE_TRACK_INFO
 {
    int32_t LBA;
@@ -57,12 +66,16 @@ class CDAccess_CHD : public CDAccess
  CDAccess_CHD(const std::string& path, bool image_memcache);
  virtual ~CDAccess_CHD();
 
- virtual bool Read_Raw_Sector(uint8 *buf, int32 lba);
+ virtual bool Read_Raw_Sector(uint8 *buf, int32 lba, bool *synth);
 
  virtual bool Fast_Read_Raw_PW_TSRE(uint8* pwbuf, int32 lba);
 
  virtual bool Read_TOC(TOC *toc);
 
+ virtual void HintReadSectors(int32_t lba, uint32_t count);
+
+ virtual bool GetCacheStats(CacheStats *stats);
+
  private:
 
  bool Load(const std::string& path, bool image_memcache);
@@ -70,6 +83,7 @@ class CDAccess_CHD : public CDAccess
 
   // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
   int32_t MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const;
+  void GenerateSubQRuns(void);
 
   bool Read_CHD_Hunk_RAW(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
   bool Read_CHD_Hunk_M1(uint8_t *buf, int32_t lba, CHDFILE_TRACK_INFO* track);
@@ -82,6 +96,7 @@ class CDAccess_CHD : public CDAccess
   uint8_t disc_type;
   TOC toc;
   CHDFILE_TRACK_INFO Tracks[100]; // Track #0(HMM?) through 99
+  std::vector<SubQRun> SubQRuns;	// Sorted by lba, for MakeSubPQ().
 
   //struct disc;
   //struct session sessions[DISC_MAX_SESSIONS];
@@ -90,8 +105,104 @@ class CDAccess_CHD : public CDAccess
   int num_tracks;
 
   chd_file *chd;
-  /* hunk data cache */
-  uint8_t *hunkmem;
-  /* last hunknum read */
-  int oldhunk;
+
+  //
+  // Decompressed hunk cache.  A hunk being decompressed is in HunkIndex but not yet ready; only ready
+  // hunks are in HunkLRU(most recently used at the front), so a hunk can't be evicted while it's
+  // being written.
+  //
+  struct HunkEntry
+  {
+   uint32_t hunknum;
+   bool ready;
+   uint8_t *data;
+   std::list<HunkEntry*>::iterator lru_pos;
+  };
+
+  uint32_t hunk_bytes;
+  uint32_t total_hunks;
+  uint32_t hunk_cache_size;
+  uint8_t *hunk_mem;
+  HunkEntry *hunk_entries;
+  std::list<HunkEntry*> HunkLRU;
+  std::map<uint32_t, HunkEntry*> HunkIndex;
+  std::vector<HunkEntry*> HunkFree;
+  uint32_t last_hunk;
+  CacheStats hunk_stats;
+
+  void InitHunkCache(const std::string& path);
+  bool InitDiscCache(const std::string& path);
+  void KillHunkCache(void);
+  HunkEntry *AllocHunk(uint32_t hunknum);
+  chd_error DecompressHunk(chd_file *cf, HunkEntry *he);
+  chd_error ReadHunkData(uint8_t *buf, uint32_t hunknum, uint32_t offset, uint32_t len);
+  chd_error ReadDiscHunkData(uint8_t *buf, uint32_t hunknum, uint32_t offset, uint32_t len);
+  void FinishDiscHunk(uint32_t hunknum, chd_error err, bool first_try);
+  int32_t LBAToHunk(int32_t lba) const;
+
+  //
+  // Hunks are decompressed ahead of the reader on a thread of its own with a chd_file of its own,
+  // as a chd_file can't be read from two threads at once.  It works through the window
+  // [prefetch_start, prefetch_end) from prefetch_next on, skipping hunks that are already cached;
+  // prefetch_start follows the reader, so that a read before it starts a new window.
+  //
+  uint32_t prefetch_hunks;
+#ifdef HAVE_THREADS
+  chd_file *prefetch_chd;
+  sthread_t *prefetch_thread;
+  slock_t *hunk_lock;
+  scond_t *hunk_cond;
+  uint32_t prefetch_start;
+  uint32_t prefetch_next;
+  uint32_t prefetch_end;
+  bool hunk_threads_exit;
+
+  static void PrefetchThreadStart(void *data);
+  void PrefetchThreadMain(void);
+#endif
+  void Prefetch(uint32_t hunknum, uint32_t count);
+
+  //
+  // With image_memcache, the whole disc is decompressed into disc_mem instead, in the background so
+  // that the game can start straight away.  Precache threads, each with a chd_file of its own, take
+  // the next empty hunk from precache_next on, which a read of an empty hunk moves to just after it.
+  // Such a read decompresses that one hunk itself; one of a hunk being decompressed waits for it.
+  //
+  enum
+  {
+   DISC_HUNK_EMPTY = 0,
+   DISC_HUNK_BUSY,
+   DISC_HUNK_READY,
+   DISC_HUNK_FAILED	// Left for reads to retry, and report.
+  };
+
+  uint8_t *disc_mem;
+  uint8_t *disc_hunk_state;
+  uint32_t precache_next;
+  uint32_t precache_left;
+  std::chrono::steady_clock::time_point precache_start_time;
+#ifdef HAVE_THREADS
+  std::vector<chd_file*> precache_chds;
+  std::vector<sthread_t*> precache_threads;
+  uint32_t precache_threads_started;
+
+  static void PrecacheThreadStart(void *data);
+  void PrecacheThreadMain(void);
+#endif
+
+  inline void LockHunks(void)
+  {
+#ifdef HAVE_THREADS
+   if(hunk_lock)
+    slock_lock(hunk_lock);
+#endif
+  }
+
+  inline void UnlockHunks(void)
+  {
+#ifdef HAVE_THREADS
+   if(hunk_lock)
+    slock_unlock(hunk_lock);
+#endif
+  }
 };
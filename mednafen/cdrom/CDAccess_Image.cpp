@@ -52,6 +52,7 @@
 #include "CDAFReader.h"
 
 #include <map>
+#include <vector>
 
 enum
 {
@@ -220,10 +221,7 @@ bool CDAccess_Image::ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int t
 
       efn = MDFN_EvalFIP(base_dir, filename);
 
-      if(image_memcache)
-         track->fp = new MemoryStream(new FileStream(efn.c_str(), MODE_READ));
-      else
-         track->fp = new FileStream(efn.c_str(), MODE_READ);
+      track->fp = CDAccess_OpenImageStream(efn, image_memcache);
 
       toc_streamcache[filename] = track->fp;
    }
@@ -680,12 +678,9 @@ bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
             else
                efn = args[0];
 
-            TmpTrack.fp = new FileStream(efn.c_str(), MODE_READ);
+            TmpTrack.fp = CDAccess_OpenImageStream(efn, image_memcache);
             TmpTrack.FirstFileInstance = 1;
 
-            if(image_memcache)
-               TmpTrack.fp = new MemoryStream(TmpTrack.fp);
-
             if(!strcasecmp(args[1].c_str(), "BINARY"))
             {
                //TmpTrack.Format = TRACK_FORMAT_DATA;
@@ -703,6 +698,13 @@ bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
                TmpTrack.AReader = CDAFR_Open(TmpTrack.fp);
                if(!TmpTrack.AReader)
                {
+#ifndef HAVE_MPC
+                  if(!strcasecmp(args[1].c_str(), "MPC") || !strcasecmp(args[1].c_str(), "MP+"))
+                  {
+                     log_cb(RETRO_LOG_ERROR, "Musepack audio tracks aren't supported by this build: %s\n", args[0].c_str());
+                     return false;
+                  }
+#endif
                   log_cb(RETRO_LOG_ERROR, "Unsupported audio track file format: %s\n", args[0].c_str());
                   return false;
                }
@@ -978,6 +980,8 @@ bool CDAccess_Image::ImageOpen(const std::string& path, bool image_memcache)
       }
    }
 
+   GenerateSubQRuns();
+
    //
    // Load SBI file, if present
    //
@@ -1038,9 +1042,8 @@ CDAccess_Image::~CDAccess_Image()
    Cleanup();
 }
 
-bool CDAccess_Image::Read_Raw_Sector(uint8_t *buf, int32_t lba)
+bool CDAccess_Image::Read_Raw_Sector(uint8_t *buf, int32_t lba, bool *synth)
 {
-   uint8_t SimuQ[0xC];
    int32_t track;
    CDRFILE_TRACK_INFO *ct;
 
@@ -1079,7 +1082,6 @@ bool CDAccess_Image::Read_Raw_Sector(uint8_t *buf, int32_t lba)
 
    memset(buf + 2352, 0, 96);
    track = MakeSubPQ(lba, buf + 2352);
-   subq_deinterleave(buf + 2352, SimuQ);
 
    ct = &Tracks[track];
 
@@ -1165,7 +1167,13 @@ bool CDAccess_Image::Read_Raw_Sector(uint8_t *buf, int32_t lba)
 
             case DI_FORMAT_MODE1:
                ct->fp->read(buf + 12 + 3 + 1, 2048);
-               encode_mode1_sector(lba + 150, buf);
+               if(synth)
+               {
+                  encode_mode1_header(lba + 150, buf);
+                  *synth = true;
+               }
+               else
+                  encode_mode1_sector(lba + 150, buf);
                break;
 
             case DI_FORMAT_MODE1_RAW:
@@ -1202,6 +1210,28 @@ bool CDAccess_Image::Read_Raw_Sector(uint8_t *buf, int32_t lba)
    return true;
 }
 
+void CDAccess_Image::HintReadSectors(int32_t lba, uint32_t count)
+{
+   for(int32_t track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+   {
+      const CDRFILE_TRACK_INFO *ct = &Tracks[track];
+      const int32_t end_lba = ct->LBA + ct->sectors;
+
+      if(lba < (ct->LBA - ct->pregap_dv) || lba >= end_lba)
+         continue;
+
+      if(!ct->AReader)
+      {
+         const uint32_t sector_size = DI_Size_Table[ct->DIFormat] + (ct->SubchannelMode ? 96 : 0);
+
+         count = std::min<uint32_t>(count, end_lba - lba);
+
+         ct->fp->prefetch(ct->FileOffset + (int64_t)(lba - ct->LBA) * sector_size, (uint64_t)count * sector_size);
+      }
+      break;
+   }
+}
+
 bool CDAccess_Image::Fast_Read_Raw_PW_TSRE(uint8_t* pwbuf, int32_t lba)
 {
    int32_t track;
@@ -1225,106 +1255,96 @@ bool CDAccess_Image::Fast_Read_Raw_PW_TSRE(uint8_t* pwbuf, int32_t lba)
 }
 
 //
-// Note: this function makes use of the current contents(as in |=) in SubPWBuf.
+// Works out the Q subchannel runs for MakeSubPQ() from the track list; a run boundary can only be at the start or end
+// of a track's pregap, data, or postgap, at an index, or 150 sectors before a track's start.
 //
-int32_t CDAccess_Image::MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const
+void CDAccess_Image::GenerateSubQRuns(void)
 {
-   uint8_t buf[0xC];
-   int32_t track;
-   uint32_t lba_relative;
-   uint32_t ma, sa, fa;
-   uint32_t m, s, f;
-   uint8_t pause_or = 0x00;
-   bool track_found = false;
+   std::vector<int32_t> bounds;
 
-   for(track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+   for(int32_t track = FirstTrack; track < (FirstTrack + NumTracks); track++)
    {
-      if(lba >= (Tracks[track].LBA - Tracks[track].pregap_dv - Tracks[track].pregap) && lba < (Tracks[track].LBA + Tracks[track].sectors + Tracks[track].postgap))
-      {
-         track_found = true;
-         break;
-      }
-   }
+      const CDRFILE_TRACK_INFO *ct = &Tracks[track];
 
-   if(!track_found)
-      throw(MDFN_Error(0, "Could not find track for sector %u!", lba));
+      bounds.push_back(ct->LBA - ct->pregap_dv - ct->pregap);
+      bounds.push_back(ct->LBA - 150);
+      bounds.push_back(ct->LBA);
+      bounds.push_back(ct->LBA + ct->sectors);
+      bounds.push_back(ct->LBA + ct->sectors + ct->postgap);
 
-   if(lba < Tracks[track].LBA)
-      lba_relative = Tracks[track].LBA - 1 - lba;
-   else
-      lba_relative = lba - Tracks[track].LBA;
-
-   f = (lba_relative % 75);
-   s = ((lba_relative / 75) % 60);
-   m = (lba_relative / 75 / 60);
+      for(int32_t i = 0; i < 100; i++)
+         bounds.push_back(ct->index[i]);
+   }
 
-   fa = (lba + 150) % 75;
-   sa = ((lba + 150) / 75) % 60;
-   ma = ((lba + 150) / 75 / 60);
+   std::sort(bounds.begin(), bounds.end());
+   bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
 
-   uint8_t adr = 0x1; // Q channel data encodes position
-   uint8_t control = Tracks[track].subq_control;
+   SubQRuns.clear();
 
-   // Handle pause(D7 of interleaved subchannel byte) bit, should be set to 1 when in pregap or postgap.
-   if((lba < Tracks[track].LBA) || (lba >= Tracks[track].LBA + Tracks[track].sectors))
+   for(size_t b = 0; b < bounds.size(); b++)
    {
-      //printf("pause_or = 0x80 --- %d\n", lba);
-      pause_or = 0x80;
-   }
+      const int32_t lba = bounds[b];
+      SubQRun run;
 
-   // Handle pregap between audio->data track
-   {
-      int32_t pg_offset = (int32_t)lba - Tracks[track].LBA;
+      memset(&run, 0, sizeof(run));
+      run.lba = lba;
 
-      // If we're more than 2 seconds(150 sectors) from the real "start" of the track/INDEX 01, and the track is a data track,
-      // and the preceding track is an audio track, encode it as audio(by taking the SubQ control field from the preceding track).
-      //
-      // TODO: Look into how we're supposed to handle subq control field in the four combinations of track types(data/audio).
-      //
-      if(pg_offset < -150)
+      for(int32_t track = FirstTrack; track < (FirstTrack + NumTracks); track++)
       {
-         if((Tracks[track].subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+         if(lba >= (Tracks[track].LBA - Tracks[track].pregap_dv - Tracks[track].pregap) && lba < (Tracks[track].LBA + Tracks[track].sectors + Tracks[track].postgap))
          {
-            //printf("Pregap part 1 audio->data: lba=%d track_lba=%d\n", lba, Tracks[track].LBA);
-            control = Tracks[track - 1].subq_control;
+            run.track = track;
+            run.track_lba = Tracks[track].LBA;
+            run.control = Tracks[track].subq_control;
+
+            // Handle pause(D7 of interleaved subchannel byte) bit, should be set to 1 when in pregap or postgap.
+            if((lba < Tracks[track].LBA) || (lba >= Tracks[track].LBA + Tracks[track].sectors))
+               run.pause = 0x80;
+
+            // If we're more than 2 seconds(150 sectors) from the real "start" of the track/INDEX 01, and the track is a data track,
+            // and the preceding track is an audio track, encode it as audio(by taking the SubQ control field from the preceding track).
+            //
+            // TODO: Look into how we're supposed to handle subq control field in the four combinations of track types(data/audio).
+            //
+            if((lba - Tracks[track].LBA) < -150)
+            {
+               if((Tracks[track].subq_control & SUBQ_CTRLF_DATA) && (FirstTrack < track) && !(Tracks[track - 1].subq_control & SUBQ_CTRLF_DATA))
+                  run.control = Tracks[track - 1].subq_control;
+            }
+
+            for(int32_t i = 0; i < 100; i++)
+            {
+               if(lba >= Tracks[track].index[i])
+                  run.index = i;
+            }
+            break;
          }
       }
-   }
-
 
-   memset(buf, 0, 0xC);
-   buf[0] = (adr << 0) | (control << 4);
-   buf[1] = U8_to_BCD(track);
-
-   // Index
-   //if(lba < Tracks[track].LBA) // Index is 00 in pregap
-   // buf[2] = U8_to_BCD(0x00);
-   //else
-   // buf[2] = U8_to_BCD(0x01);
-   {
-      int index = 0;
-
-      for(int32_t i = 0; i < 100; i++)
+      if(SubQRuns.size())
       {
-         if(lba >= Tracks[track].index[i])
-            index = i;
+         const SubQRun &prev = SubQRuns.back();
+
+         if(prev.track == run.track && prev.track_lba == run.track_lba && prev.index == run.index && prev.control == run.control && prev.pause == run.pause)
+            continue;
       }
-      buf[2] = U8_to_BCD(index);
-   }
 
-   // Track relative MSF address
-   buf[3] = U8_to_BCD(m);
-   buf[4] = U8_to_BCD(s);
-   buf[5] = U8_to_BCD(f);
+      SubQRuns.push_back(run);
+   }
+}
 
-   buf[6] = 0; // Zerroooo
+//
+// Note: this function makes use of the current contents(as in |=) in SubPWBuf.
+//
+int32_t CDAccess_Image::MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const
+{
+   const SubQRun *run = subq_find_run(SubQRuns.data(), SubQRuns.size(), lba);
+   uint8_t buf[0xC];
 
-   // Absolute MSF address
-   buf[7] = U8_to_BCD(ma);
-   buf[8] = U8_to_BCD(sa);
-   buf[9] = U8_to_BCD(fa);
+   if(!run)
+      throw(MDFN_Error(0, "Could not find track for sector %u!", lba));
 
-   subq_generate_checksum(buf);
+   subq_synth_run(*run, lba, buf);
 
    if(!SubQReplaceMap.empty())
    {
@@ -1339,10 +1359,9 @@ int32_t CDAccess_Image::MakeSubPQ(int32_t lba, uint8_t *SubPWBuf) const
       }
    }
 
-   for(int i = 0; i < 96; i++)
-      SubPWBuf[i] |= (((buf[i >> 3] >> (7 - (i & 0x7))) & 1) ? 0x40 : 0x00) | pause_or;
+   subpq_interleave(buf, run->pause, SubPWBuf);
 
-   return track;
+   return run->track;
 }
 
 bool CDAccess_Image::Read_TOC(TOC *rtoc)
@@ -2,6 +2,7 @@
 #define __MDFN_CDACCESS_IMAGE_H
 
 #include <map>
+#include <vector>
 
 #include "CDUtility.h"
 
@@ -58,12 +59,14 @@ class CDAccess_Image : public CDAccess
       CDAccess_Image(const std::string& path, bool image_memcache);
       virtual ~CDAccess_Image();
 
-      virtual bool Read_Raw_Sector(uint8_t *buf, int32_t lba);
+      virtual bool Read_Raw_Sector(uint8_t *buf, int32_t lba, bool *synth);
 
       virtual bool Fast_Read_Raw_PW_TSRE(uint8_t* pwbuf, int32_t lba);
 
       virtual bool Read_TOC(TOC *toc);
 
+      virtual void HintReadSectors(int32_t lba, uint32_t count);
+
    private:
 
       int32_t NumTracks;
@@ -76,11 +79,14 @@ class CDAccess_Image : public CDAccess
 
       std::map<uint32_t, stl_array<uint8_t, 12> > SubQReplaceMap;
 
+      std::vector<SubQRun> SubQRuns;	// Sorted by lba, for MakeSubPQ().
+
       std::string base_dir;
 
       bool ImageOpen(const std::string& path, bool image_memcache);
       bool LoadSBI(const std::string& sbi_path);
       void GenerateTOC(void);
+      void GenerateSubQRuns(void);
       void Cleanup(void);
 
       // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
@@ -18,6 +18,7 @@
  */
 
 #include "../mednafen.h"
+#include "../mednafen-endian.h"
 #include "CDUtility.h"
 #include "dvdisaster.h"
 #include "lec.h"
@@ -109,6 +110,11 @@ void encode_mode1_sector(uint32_t aba, uint8_t *sector_data)
    lec_encode_mode1_sector(aba, sector_data);
 }
 
+void encode_mode1_header(uint32_t aba, uint8_t *sector_data)
+{
+   lec_encode_mode1_header(aba, sector_data);
+}
+
 void encode_mode2_sector(uint32_t aba, uint8_t *sector_data)
 {
    CDUtility_Init();
@@ -178,10 +184,11 @@ void subq_generate_checksum(uint8_t *buf)
 void subq_deinterleave(const uint8_t *SubPWBuf, uint8_t *qbuf)
 {
    unsigned i;
-   memset(qbuf, 0, 0xC);
 
-   for(i = 0; i < 96; i++)
-      qbuf[i >> 3] |= ((SubPWBuf[i] >> 6) & 0x1) << (7 - (i & 0x7));
+   // Bit 6 of each of 8 PW bytes, moved down to bit 0, then gathered by the multiply into the top byte, first PW byte
+   // into the top bit.
+   for(i = 0; i < 12; i++)
+      qbuf[i] = (((MDFN_de64lsb(SubPWBuf + i * 8) >> 6) & 0x0101010101010101ULL) * 0x8040201008040201ULL) >> 56;
 }
 
 
@@ -218,6 +225,81 @@ void subpw_interleave(const uint8_t *in_buf, uint8_t *out_buf)
    }
 }
 
+void subpq_interleave(const uint8_t *subq_buf, uint8_t p, uint8_t *subpw_buf)
+{
+   const uint64_t p_bits = p * 0x0101010101010101ULL;
+   unsigned i;
+
+   // The Q byte is copied into all 8 bytes, each keeps the one bit it carries(top bit in the first byte), and
+   // adding 0x7F carries any that are set up to bit 7, which is then shifted down to bit 6.
+   for(i = 0; i < 12; i++)
+   {
+      const uint64_t q_bits = ((((subq_buf[i] * 0x0101010101010101ULL) & 0x0102040810204080ULL) + 0x7F7F7F7F7F7F7F7FULL) & 0x8080808080808080ULL) >> 1;
+
+      MDFN_en64lsb(subpw_buf + i * 8, MDFN_de64lsb(subpw_buf + i * 8) | q_bits | p_bits);
+   }
+}
+
+const SubQRun *subq_find_run(const SubQRun *runs, size_t count, int32_t lba)
+{
+   size_t lo = 0;
+   size_t hi = count;
+
+   // Find the first run starting after "lba"; it's in the one before.
+   while(lo < hi)
+   {
+      const size_t mid = (lo + hi) / 2;
+
+      if(runs[mid].lba <= lba)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+
+   if(!lo || !runs[lo - 1].track)
+      return NULL;
+
+   return &runs[lo - 1];
+}
+
+void subq_synth_run(const SubQRun &run, int32_t lba, uint8_t *buf)
+{
+   uint32_t lba_relative;
+   uint32_t ma, sa, fa;
+   uint32_t m, s, f;
+
+   if(lba < run.track_lba)
+      lba_relative = run.track_lba - 1 - lba;
+   else
+      lba_relative = lba - run.track_lba;
+
+   f = (lba_relative % 75);
+   s = ((lba_relative / 75) % 60);
+   m = (lba_relative / 75 / 60);
+
+   fa = (lba + 150) % 75;
+   sa = ((lba + 150) / 75) % 60;
+   ma = ((lba + 150) / 75 / 60);
+
+   buf[0] = ADR_CURPOS | (run.control << 4);
+   buf[1] = U8_to_BCD(run.track);
+   buf[2] = U8_to_BCD(run.index);
+
+   // Track relative MSF address
+   buf[3] = U8_to_BCD(m);
+   buf[4] = U8_to_BCD(s);
+   buf[5] = U8_to_BCD(f);
+
+   buf[6] = 0;
+
+   // Absolute MSF address
+   buf[7] = U8_to_BCD(ma);
+   buf[8] = U8_to_BCD(sa);
+   buf[9] = U8_to_BCD(fa);
+
+   subq_generate_checksum(buf);
+}
+
 // NOTES ON LEADOUT AREA SYNTHESIS
 //
 //  I'm not trusting that the "control" field for the TOC leadout entry will always be set properly, so | the control fields for the last track entry
@@ -268,8 +350,8 @@ void subpw_synth_leadout_lba(const TOC& toc, const int32_t lba, uint8_t* SubPWBu
 
    subq_generate_checksum(buf);
 
-   for(int i = 0; i < 96; i++)
-      SubPWBuf[i] = (((buf[i >> 3] >> (7 - (i & 0x7))) & 1) ? 0x40 : 0x00) | 0x80;
+   memset(SubPWBuf, 0, 96);
+   subpq_interleave(buf, 0x80, SubPWBuf);
 }
 
 void synth_leadout_sector_lba(uint8_t mode, const TOC& toc, const int32_t lba, uint8_t* out_buf)
@@ -358,8 +440,8 @@ void subpw_synth_udapp_lba(const TOC& toc, const int32_t lba, const int32_t lba_
 
    subq_generate_checksum(buf);
 
-   for(int i = 0; i < 96; i++)
-      SubPWBuf[i] = (((buf[i >> 3] >> (7 - (i & 0x7))) & 1) ? 0x40 : 0x00) | 0x80;
+   memset(SubPWBuf, 0, 96);
+   subpq_interleave(buf, 0x80, SubPWBuf);
 }
 
 void synth_udapp_sector_lba(uint8_t mode, const TOC& toc, const int32_t lba, int32_t lba_subq_relative_offs, uint8_t* out_buf)
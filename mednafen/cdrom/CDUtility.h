@@ -171,6 +171,10 @@
  void encode_mode2_form1_sector(uint32_t aba, uint8_t *sector_data);	// 2048+8 bytes of user data at offset 16
  void encode_mode2_form2_sector(uint32_t aba, uint8_t *sector_data);	// 2324+8 bytes of user data at offset 16
 
+ // Writes only the sync pattern and header of a mode 1 sector; the EDC and L-EC fields are left as-is,
+ // and can be filled in later with encode_mode1_sector().
+ void encode_mode1_header(uint32_t aba, uint8_t *sector_data);
+
 
  // User data area pre-pause(MSF 00:00:00 through 00:01:74), lba -150 through -1
  // out_buf must be able to contain 2352+96 bytes.
@@ -225,6 +229,27 @@
  // Interleaves 96 bytes of subchannel P-W data from 96 bytes of uninterleaved subchannel PW data.
  void subpw_interleave(const uint8_t *in_buf, uint8_t *out_buf);
 
+ // ORs 12 bytes of subchannel Q data, and "p"(0x80 or 0x00) as the P subchannel, into 96 bytes of interleaved subchannel PW data.
+ void subpq_interleave(const uint8_t *subq_buf, uint8_t p, uint8_t *subpw_buf);
+
+ // Current position Q subchannel data for a run of sectors that share a track, index, control field and pause flag; a disc image
+ // can work these out from its track list once, instead of for every sector read.
+ struct SubQRun
+ {
+  int32_t lba;		// First sector of the run; it ends where the next one starts.
+  int32_t track_lba;	// Track start(INDEX 01); the track relative address counts down to it, and up from it.
+  uint8_t track;	// 0 if the run isn't in any track.
+  uint8_t index;
+  uint8_t control;
+  uint8_t pause;	// P subchannel, 0x80 in pregaps and postgaps.
+ };
+
+ // Returns the run sector "lba" is in, or NULL if it isn't in any track.  "runs" must be sorted by lba.
+ const SubQRun *subq_find_run(const SubQRun *runs, size_t count, int32_t lba);
+
+ // Generates the 12 bytes of Q subchannel data, checksum included, for sector "lba" of "run".
+ void subq_synth_run(const SubQRun &run, int32_t lba, uint8_t *subq_buf);
+
  // Extrapolates Q subchannel current position data from subq_input, with frame/sector delta position_delta, and writes to subq_output.
  // Only valid for ADR_CURPOS.
  // subq_input must pass subq_check_checksum().
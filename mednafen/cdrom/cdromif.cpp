@@ -26,8 +26,15 @@
 #include <algorithm>
 
 #include <boolean.h>
+
+#if defined(HAVE_THREADS) && defined(_MSC_VER) && _MSC_VER < 1700
+/* No <atomic> before Visual C++ 2012; read the disc on the emulation thread there. */
+#undef HAVE_THREADS
+#endif
+
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
+#include <atomic>
 #endif
 #include <retro_miscellaneous.h>
 
@@ -42,7 +49,8 @@ enum
    CDIF_MSG_DIEDIEDIE,		   /* Emu -> read */
 
    CDIF_MSG_READ_SECTOR		   /* Emu -> read
-                              args[0] = lba
+                              No args; wakes the read thread to look at
+                              the requested LBA(see CDIF_MT::RequestSector())
                               */
 };
 
@@ -79,13 +87,17 @@ class CDIF_Queue
       scond_t *ze_cond;
 };
 
-typedef struct
+// Written by the read thread only.  "seq" is odd while the slot is being rewritten, and is bumped
+// again once it's done; a reader that sees the same even "seq" before and after copying the
+// slot got a consistent copy(seqlock).
+struct CDIF_Sector_Buffer
 {
-   bool valid;
+   std::atomic<uint32_t> seq;
+   std::atomic<int32_t> lba;
    bool error;
-   int32_t lba;
+   bool synth;
    uint8_t data[2352 + 96];
-} CDIF_Sector_Buffer;
+};
 
 // TODO: prohibit copy constructor
 class CDIF_MT : public CDIF
@@ -95,15 +107,21 @@ class CDIF_MT : public CDIF
       CDIF_MT(CDAccess *cda);
       virtual ~CDIF_MT();
 
-      virtual void HintReadSector(int32_t lba);
-      virtual bool ReadRawSector(uint8_t *buf, int32_t lba);
+      virtual void HintReadSector(int32_t lba, uint32_t count = 1);
+      virtual bool ReadRawSector(uint8_t *buf, int32_t lba, bool *synth = NULL);
       virtual bool ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullread);
+      virtual bool GetReadAheadStats(ReadAheadStats *stats);
+      virtual bool GetImageCacheStats(CDAccess::CacheStats *stats);
 
       // FIXME: Semi-private:
       int ReadThreadStart(void);
 
    private:
 
+      void RequestSector(int32_t lba, bool wake = true);
+      bool IsSectorBuffered(int32_t lba) const;
+      bool ReadBufferedSector(uint8_t *buf, int32_t lba, bool *error_condition, bool *synth_sector);
+
       CDAccess *disc_cdaccess;
 
       sthread_t *CDReadThread;
@@ -111,23 +129,48 @@ class CDIF_MT : public CDIF
       // Queue for messages to the read thread.
       CDIF_Queue ReadThreadQueue;
 
+      // The most recently requested sector, and a count of requests.  Requests made while the read
+      // thread is busy are picked up between sectors; only when it's idle(ReadThreadIdle set), and
+      // the request needs it, is it woken through ReadThreadQueue.  Requests it didn't get to in
+      // time are superseded.
+      std::atomic<int32_t> ReqLBA;
+      std::atomic<uint32_t> ReqCount;
+      std::atomic<bool> ReadThreadIdle;
+
       // Queue for messages to the emu thread.
       CDIF_Queue EmuThreadQueue;
 
 
-      enum { SBSize = 256 };
-      CDIF_Sector_Buffer SectorBuffers[SBSize];
+      // Sector "lba" is kept in SectorBuffers[SBIndex(lba)], so a lookup is a single compare,
+      // and reading up to SBSize / 2 sectors ahead never evicts the SBSize / 2 sectors
+      // before the one being read.
+      uint32_t SBSize;
+      CDIF_Sector_Buffer *SectorBuffers;
 
-      uint32_t SBWritePos;
+      inline uint32_t SBIndex(int32_t lba) const
+      {
+         return (uint32_t)(lba - LBA_Read_Minimum) % SBSize;
+      }
 
+      // Sectors are handed over without locking; these are only used to sleep when the sector
+      // wanted isn't there yet(SBWaiting set), and to wake the emu thread back up.
       slock_t *SBMutex;
       scond_t *SBCond;
+      std::atomic<bool> SBWaiting;
+
+      std::atomic<uint32_t> stat_depth;
 
+      /* Emu-thread-only: */
+      uint64_t stat_hits;
+      uint64_t stat_stalls;
 
       /* Read-thread-only: */
       int32_t ra_lba;
       int32_t ra_count;
+      int32_t ra_depth;
+      int32_t ra_seq_run;
       int32_t last_read_lba;
+      uint32_t last_req_count;
 };
 #endif
 
@@ -139,14 +182,19 @@ class CDIF_ST : public CDIF
       CDIF_ST(CDAccess *cda);
       virtual ~CDIF_ST();
 
-      virtual void HintReadSector(int32_t lba);
-      virtual bool ReadRawSector(uint8_t *buf, int32_t lba);
+      virtual void HintReadSector(int32_t lba, uint32_t count = 1);
+      virtual bool ReadRawSector(uint8_t *buf, int32_t lba, bool *synth = NULL);
       virtual bool ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullread);
+      virtual bool GetImageCacheStats(CDAccess::CacheStats *stats);
 
    private:
       CDAccess *disc_cdaccess;
 };
 
+// Longest run of sectors passed on to CDAccess::HintReadSectors(), so that long CD-DA plays
+// don't have the OS fetch tens of megabytes at once.
+static const uint32_t HintReadMax = 2048;
+
 CDIF::CDIF() : UnrecoverableError(false)
 {
 
@@ -257,11 +305,18 @@ static int ReadThreadStart_C(void *v_arg)
 
 int CDIF_MT::ReadThreadStart()
 {
+   // Read-ahead depth, in sectors. It doubles each time that many sectors are requested
+   // in sequence(FMV, CD-DA; requests skipping ahead into what's been read ahead count too),
+   // and halves on every seek.
+   const int32_t min_depth = 8;
+   const int32_t initial_depth = 16;
+   const int32_t max_depth = SBSize / 2;
    bool Running = true;
 
-   SBWritePos = 0;
    ra_lba = 0;
    ra_count = 0;
+   ra_depth = initial_depth;
+   ra_seq_run = 0;
    last_read_lba = LBA_Read_Maximum + 1;
 
    disc_cdaccess->Read_TOC(&disc_toc);
@@ -271,54 +326,66 @@ int CDIF_MT::ReadThreadStart()
       log_cb(RETRO_LOG_ERROR, "TOC first(%d)/last(%d) track numbers bad.\n", disc_toc.first_track, disc_toc.last_track);
    }
 
-   SBWritePos = 0;
    ra_lba = 0;
    ra_count = 0;
+   ra_depth = initial_depth;
+   ra_seq_run = 0;
    last_read_lba = LBA_Read_Maximum + 1;
-   memset(SectorBuffers, 0, SBSize * sizeof(CDIF_Sector_Buffer));
+   last_req_count = ReqCount.load(std::memory_order_relaxed);
 
    EmuThreadQueue.Write(CDIF_Message(CDIF_MSG_DONE));
 
    while(Running)
    {
       CDIF_Message msg;
+      bool blocking = false;
 
-      // Only do a blocking-wait for a message if we don't have any sectors to read-ahead.
+      // Only do a blocking-wait for a message if we don't have any sectors to read-ahead,
+      // and no new sector has been requested since we last looked.
       // MDFN_DispMessage("%d %d %d\n", last_read_lba, ra_lba, ra_count);
-      if(ReadThreadQueue.Read(&msg, ra_count ? false : true))
+      if(!ra_count)
       {
-         switch(msg.message)
+         ReadThreadIdle.store(true, std::memory_order_relaxed);
+         // Pairs with the fence in RequestSector(): either we see its request, or it sees us idle.
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+         blocking = (ReqCount.load(std::memory_order_relaxed) == last_req_count);
+      }
+
+      if(ReadThreadQueue.Read(&msg, blocking))
+      {
+         if(msg.message == CDIF_MSG_DIEDIEDIE)
+            Running = false;
+      }
+
+      ReadThreadIdle.store(false, std::memory_order_relaxed);
+
+      const uint32_t req_count = ReqCount.load(std::memory_order_acquire);
+
+      if(req_count != last_req_count)
+      {
+         int32_t new_lba = ReqLBA.load(std::memory_order_relaxed);
+
+         last_req_count = req_count;
+
+         if(new_lba > last_read_lba && new_lba <= MAX(ra_lba, last_read_lba + 1))
+         {
+            ra_seq_run += new_lba - last_read_lba;
+
+            if(ra_seq_run >= ra_depth && ra_depth < max_depth)
+            {
+               ra_depth = MIN(ra_depth * 2, max_depth);
+               ra_seq_run = 0;
+            }
+         }
+         else if(new_lba != last_read_lba)
          {
-            case CDIF_MSG_DIEDIEDIE:
-               Running = false;
-               break;
-
-            case CDIF_MSG_READ_SECTOR:
-               {
-                  static const int max_ra = 16;
-                  static const int initial_ra = 1;
-                  static const int speedmult_ra = 2;
-                  int32_t new_lba = msg.args[0];
-
-                  if(new_lba == (last_read_lba + 1))
-                  {
-                     int how_far_ahead = ra_lba - new_lba;
-
-                     if(how_far_ahead <= max_ra)
-                        ra_count = MIN(speedmult_ra, 1 + max_ra - how_far_ahead);
-                     else
-                        ra_count++;
-                  }
-                  else if(new_lba != last_read_lba)
-                  {
-                     ra_lba = new_lba;
-                     ra_count = initial_ra;
-                  }
-
-                  last_read_lba = new_lba;
-               }
-               break;
+            ra_depth = MAX(ra_depth / 2, min_depth);
+            ra_seq_run = 0;
+            ra_lba = new_lba;
          }
+
+         ra_count = MAX(0, new_lba + ra_depth - ra_lba);
+         last_read_lba = new_lba;
       }
 
       /* Don't read beyond what the disc (image) readers can handle sanely. */
@@ -329,19 +396,33 @@ int CDIF_MT::ReadThreadStart()
       {
          uint8_t tmpbuf[2352 + 96];
          bool error_condition = false;
+         bool synth = false;
+
+         disc_cdaccess->Read_Raw_Sector(tmpbuf, ra_lba, &synth);
+
+         CDIF_Sector_Buffer *sb = &SectorBuffers[SBIndex(ra_lba)];
+         const uint32_t seq = sb->seq.load(std::memory_order_relaxed);
 
-         disc_cdaccess->Read_Raw_Sector(tmpbuf, ra_lba);
+         sb->seq.store(seq + 1, std::memory_order_relaxed);
+         std::atomic_thread_fence(std::memory_order_release);
 
-         slock_lock(SBMutex);
+         sb->lba.store(ra_lba, std::memory_order_relaxed);
+         memcpy(sb->data, tmpbuf, 2352 + 96);
+         sb->error = error_condition;
+         sb->synth = synth;
 
-         SectorBuffers[SBWritePos].lba = ra_lba;
-         memcpy(SectorBuffers[SBWritePos].data, tmpbuf, 2352 + 96);
-         SectorBuffers[SBWritePos].valid = true;
-         SectorBuffers[SBWritePos].error = error_condition;
-         SBWritePos = (SBWritePos + 1) % SBSize;
+         sb->seq.store(seq + 2, std::memory_order_release);
+         stat_depth.store(ra_depth, std::memory_order_relaxed);
 
-         scond_signal(SBCond);
-         slock_unlock(SBMutex);
+         // Pairs with the fence in ReadRawSector(): either it sees this sector, or this sees SBWaiting.
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+
+         if(SBWaiting.load(std::memory_order_relaxed))
+         {
+            slock_lock(SBMutex);
+            scond_signal(SBCond);
+            slock_unlock(SBMutex);
+         }
 
          ra_lba++;
          ra_count--;
@@ -351,11 +432,21 @@ int CDIF_MT::ReadThreadStart()
    return(1);
 }
 
-CDIF_MT::CDIF_MT(CDAccess *cda) : disc_cdaccess(cda), CDReadThread(NULL), SBMutex(NULL), SBCond(NULL)
+CDIF_MT::CDIF_MT(CDAccess *cda) : disc_cdaccess(cda), CDReadThread(NULL), ReqLBA(0), ReqCount(0),
+   ReadThreadIdle(false), SBMutex(NULL), SBCond(NULL), SBWaiting(false), stat_depth(0), stat_hits(0), stat_stalls(0)
 {
    CDIF_Message msg;
    RTS_Args s;
 
+   SBSize             = MAX(64, MDFN_GetSettingUI("pcfx.cd_readahead_size"));
+   SectorBuffers      = new CDIF_Sector_Buffer[SBSize];
+
+   for(uint32_t i = 0; i < SBSize; i++)
+   {
+      SectorBuffers[i].seq.store(0, std::memory_order_relaxed);
+      SectorBuffers[i].lba.store(LBA_Read_Maximum + 1, std::memory_order_relaxed);
+   }
+
    SBMutex            = slock_new();
    SBCond             = scond_new();
 
@@ -387,9 +478,26 @@ CDIF_MT::~CDIF_MT()
       scond_free(SBCond);
       SBCond = NULL;
    }
+
+   delete[] SectorBuffers;
 }
 #endif
 
+void CDIF::FinishRawSector(uint8_t *buf, int32_t lba, bool synth_sector, bool *synth)
+{
+   if(synth)
+      *synth = synth_sector;
+   else if(synth_sector)
+      encode_mode1_sector(lba + 150, buf);
+}
+
+bool CDIF::GetReadAheadStats(ReadAheadStats *stats)
+{
+   memset(stats, 0, sizeof(*stats));
+
+   return(false);
+}
+
 bool CDIF::ValidateRawSector(uint8_t *buf)
 {
    int mode = buf[12 + 3];
@@ -404,10 +512,53 @@ bool CDIF::ValidateRawSector(uint8_t *buf)
 }
 
 #ifdef HAVE_THREADS
-bool CDIF_MT::ReadRawSector(uint8_t *buf, int32_t lba)
+void CDIF_MT::RequestSector(int32_t lba, bool wake)
+{
+   ReqLBA.store(lba, std::memory_order_relaxed);
+   ReqCount.fetch_add(1, std::memory_order_release);
+
+   if(!wake)
+      return;
+
+   std::atomic_thread_fence(std::memory_order_seq_cst);
+
+   if(ReadThreadIdle.load(std::memory_order_relaxed))
+      ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR));
+}
+
+bool CDIF_MT::IsSectorBuffered(int32_t lba) const
+{
+   const CDIF_Sector_Buffer *sb = &SectorBuffers[SBIndex(lba)];
+
+   return(!(sb->seq.load(std::memory_order_acquire) & 1) && sb->lba.load(std::memory_order_relaxed) == lba);
+}
+
+bool CDIF_MT::ReadBufferedSector(uint8_t *buf, int32_t lba, bool *error_condition, bool *synth_sector)
+{
+   const CDIF_Sector_Buffer *sb = &SectorBuffers[SBIndex(lba)];
+
+   for(;;)
+   {
+      const uint32_t seq = sb->seq.load(std::memory_order_acquire);
+
+      if((seq & 1) || sb->lba.load(std::memory_order_relaxed) != lba)
+         return(false);
+
+      *error_condition = sb->error;
+      *synth_sector = sb->synth;
+      memcpy(buf, sb->data, 2352 + 96);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if(sb->seq.load(std::memory_order_relaxed) == seq)
+         return(true);
+   }
+}
+
+bool CDIF_MT::ReadRawSector(uint8_t *buf, int32_t lba, bool *synth)
 {
-   bool found = false;
    bool error_condition = false;
+   bool synth_sector = false;
 
    if(UnrecoverableError)
    {
@@ -421,27 +572,30 @@ bool CDIF_MT::ReadRawSector(uint8_t *buf, int32_t lba)
       return(false);
    }
 
-   ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
-
-   slock_lock(SBMutex);
-
-   do
+   if(ReadBufferedSector(buf, lba, &error_condition, &synth_sector))
    {
-      for(int i = 0; i < SBSize; i++)
-      {
-         if(SectorBuffers[i].valid && SectorBuffers[i].lba == lba)
-         {
-            error_condition = SectorBuffers[i].error;
-            memcpy(buf, SectorBuffers[i].data, 2352 + 96);
-            found = true;
-         }
-      }
+      // While the next several sectors are already buffered, the read thread can pick up
+      // this request whenever it next wakes up.
+      RequestSector(lba, !IsSectorBuffered(lba + 8));
+      stat_hits++;
+   }
+   else
+   {
+      RequestSector(lba);
+      stat_stalls++;
 
-      if(!found)
+      slock_lock(SBMutex);
+      SBWaiting.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      while(!ReadBufferedSector(buf, lba, &error_condition, &synth_sector))
          scond_wait((scond_t*)SBCond, (slock_t*)SBMutex);
-   } while(!found);
 
-   slock_unlock(SBMutex);
+      SBWaiting.store(false, std::memory_order_relaxed);
+      slock_unlock(SBMutex);
+   }
+
+   FinishRawSector(buf, lba, synth_sector, synth);
 
    return(!error_condition);
 }
@@ -463,28 +617,47 @@ bool CDIF_MT::ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullrea
    if(disc_cdaccess->Fast_Read_Raw_PW_TSRE(pwbuf, lba))
    {
       if(hint_fullread)
-         ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
+         RequestSector(lba);
 
       return(true);
    }
    else
    {
       uint8_t tmpbuf[2352 + 96];
+      bool synth;
       bool ret;
 
-      ret = ReadRawSector(tmpbuf, lba);
+      ret = ReadRawSector(tmpbuf, lba, &synth);	// Only PW is wanted, no need for L-EC synthesis.
       memcpy(pwbuf, tmpbuf + 2352, 96);
 
       return ret;
    }
 }
 
-void CDIF_MT::HintReadSector(int32_t lba)
+void CDIF_MT::HintReadSector(int32_t lba, uint32_t count)
 {
    if(UnrecoverableError)
       return;
 
-   ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
+   RequestSector(lba);
+
+   if(count > 1)
+      disc_cdaccess->HintReadSectors(lba, MIN(count, HintReadMax));
+}
+
+bool CDIF_MT::GetReadAheadStats(ReadAheadStats *stats)
+{
+   stats->buffer_size = SBSize;
+   stats->depth = stat_depth.load(std::memory_order_relaxed);
+   stats->hits = stat_hits;
+   stats->stalls = stat_stalls;
+
+   return(true);
+}
+
+bool CDIF_MT::GetImageCacheStats(CDAccess::CacheStats *stats)
+{
+   return disc_cdaccess->GetCacheStats(stats);
 }
 #endif
 
@@ -498,11 +671,12 @@ int CDIF::ReadSector(uint8_t* buf, int32_t lba, uint32_t sector_count, bool supp
    while(sector_count--)
    {
       uint8_t tmpbuf[2352 + 96];
+      bool synth = false;
 
-      if(!ReadRawSector(tmpbuf, lba))
+      if(!ReadRawSector(tmpbuf, lba, &synth))
          return(false);
 
-      if(!ValidateRawSector(tmpbuf))
+      if(!synth && !ValidateRawSector(tmpbuf))
          return(false);
 
       const int mode = tmpbuf[12 + 3];
@@ -547,13 +721,20 @@ CDIF_ST::~CDIF_ST()
 
 }
 
-void CDIF_ST::HintReadSector(int32_t lba)
+void CDIF_ST::HintReadSector(int32_t lba, uint32_t count)
 {
-   // TODO: disc_cdaccess seek hint? (probably not, would require asynchronousitycamel)
+   if(UnrecoverableError)
+      return;
+
+   // No read thread here, but the OS can still fetch a mapped image in the background.
+   if(count > 1)
+      disc_cdaccess->HintReadSectors(lba, MIN(count, HintReadMax));
 }
 
-bool CDIF_ST::ReadRawSector(uint8_t *buf, int32_t lba)
+bool CDIF_ST::ReadRawSector(uint8_t *buf, int32_t lba, bool *synth)
 {
+   bool synth_sector = false;
+
    if(UnrecoverableError)
    {
       memset(buf, 0, 2352 + 96);
@@ -566,7 +747,9 @@ bool CDIF_ST::ReadRawSector(uint8_t *buf, int32_t lba)
       return(false);
    }
 
-   disc_cdaccess->Read_Raw_Sector(buf, lba);
+   disc_cdaccess->Read_Raw_Sector(buf, lba, &synth_sector);
+
+   FinishRawSector(buf, lba, synth_sector, synth);
 
    return(true);
 }
@@ -590,15 +773,21 @@ bool CDIF_ST::ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullrea
    else
    {
       uint8_t tmpbuf[2352 + 96];
+      bool synth;
       bool ret;
 
-      ret = ReadRawSector(tmpbuf, lba);
+      ret = ReadRawSector(tmpbuf, lba, &synth);	// Only PW is wanted, no need for L-EC synthesis.
       memcpy(pwbuf, tmpbuf + 2352, 96);
 
       return ret;
    }
 }
 
+bool CDIF_ST::GetImageCacheStats(CDAccess::CacheStats *stats)
+{
+   return disc_cdaccess->GetCacheStats(stats);
+}
+
 CDIF *CDIF_Open(const std::string& path, bool image_memcache)
 {
    CDAccess *cda = CDAccess_Open(path, image_memcache);
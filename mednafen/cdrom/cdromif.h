@@ -19,6 +19,7 @@
 #define __MDFN_CDROM_CDROMIF_H
 
 #include "CDUtility.h"
+#include "CDAccess.h"
 #include <mednafen/Stream.h>
 
 #include <queue>
@@ -38,8 +39,14 @@ class CDIF
   *read_target = disc_toc;
  }
 
- virtual void HintReadSector(int32_t lba) = 0;
- virtual bool ReadRawSector(uint8_t *buf, int32_t lba) = 0;		// Reads 2352+96 bytes of data into buf.
+ // Hints that "count" sectors from "lba" on are about to be read.
+ virtual void HintReadSector(int32_t lba, uint32_t count = 1) = 0;
+ // Reads 2352+96 bytes of data into buf.
+ //
+ // If "synth" is non-NULL, *synth is set to true for mode 1 sectors synthesized from user data alone,
+ // whose EDC and L-EC fields are then left unfilled(see CDAccess::Read_Raw_Sector()); such sectors
+ // needn't be validated either.  Otherwise, the full raw sector is always returned.
+ virtual bool ReadRawSector(uint8_t *buf, int32_t lba, bool *synth = NULL) = 0;
  virtual bool ReadRawSectorPWOnly(uint8_t* pwbuf, int32_t lba, bool hint_fullread) = 0;	// Reads 96 bytes(of raw subchannel PW data) into pwbuf.
 
  // Call for mode 1 or mode 2 form 1 only.
@@ -50,7 +57,25 @@ class CDIF
  // Will return the type(1, 2) of the first sector read to the buffer supplied, 0 on error
  int ReadSector(uint8_t* buf, int32_t lba, uint32_t sector_count, bool suppress_uncorrectable_message = false);
 
+ struct ReadAheadStats
+ {
+  uint32_t buffer_size;	// Sectors the read-ahead buffer holds.
+  uint32_t depth;	// Sectors currently being read ahead of the last requested one.
+  uint64_t hits;	// Raw sector reads served from the buffer straight away.
+  uint64_t stalls;	// Raw sector reads that had to wait for the read thread.
+ };
+
+ // Returns false if sectors aren't read ahead(single-threaded or memory-cached disc).
+ virtual bool GetReadAheadStats(ReadAheadStats *stats);
+
+ // Returns false if the disc image isn't decompressed through a cache(see CDAccess::GetCacheStats()).
+ virtual bool GetImageCacheStats(CDAccess::CacheStats *stats) = 0;
+
  protected:
+ // Hands a sector read with synth_sector set back to a ReadRawSector() caller, filling in its EDC and L-EC
+ // fields unless the caller asked to be told about it instead.
+ static void FinishRawSector(uint8_t *buf, int32_t lba, bool synth_sector, bool *synth);
+
  bool UnrecoverableError;
  TOC disc_toc;
 };
@@ -77,6 +77,16 @@ uint32_t EDCCrc32(const unsigned char*, int);
 #define GF_FIELDMAX (GF_FIELDSIZE-1)
 #define GF_ALPHA0 GF_FIELDMAX
 
+/* Products of a pair of constants c0, c1 with all low and high nibbles;
+   ck*x = lo[k][x & 15] ^ hi[k][x >> 4], which PSHUFB/TBL can look up
+   16 at a time. The plain C version uses full[x] = c0*x | c1*x << 8. */
+
+typedef struct _GaloisMulTable2
+{  uint8_t lo[2][16];
+   uint8_t hi[2][16];
+   uint16_t full[256];
+} GaloisMulTable2;
+
 /* Lookup tables for Galois field arithmetic */
 
 typedef struct _GaloisTables
@@ -100,6 +110,9 @@ typedef struct _ReedSolomonTables
 GaloisTables* CreateGaloisTables(int32_t);
 void FreeGaloisTables(GaloisTables*);
 
+void CreateGaloisMulTable2(GaloisMulTable2*, int32_t, int32_t, int32_t);
+void GaloisMulSum2(uint8_t*, uint8_t*, const uint8_t*, int, const GaloisMulTable2*, int, int);
+
 ReedSolomonTables *CreateReedSolomonTables(GaloisTables*, int32_t, int32_t, int);
 void FreeReedSolomonTables(ReedSolomonTables*);
 
@@ -128,12 +141,16 @@ void AndPVector(unsigned char*, unsigned char, int);
 void OrPVector(unsigned char*, unsigned char, int);
 
 void GetQVector(unsigned char*, unsigned char*, int);
+void GetQVectorsElement(unsigned char*, unsigned char*, int);
 void SetQVector(unsigned char*, unsigned char*, int);
 void FillQVector(unsigned char*, unsigned char, int);
 void AndQVector(unsigned char*, unsigned char, int);
 void OrQVector(unsigned char*, unsigned char, int);
 
 int DecodePQ(ReedSolomonTables*, unsigned char*, int, int*, int);
+void InitPQSyndromes(GaloisTables*);
+void CalcPSyndromes(unsigned char*, unsigned char*, unsigned char*);
+void CalcQSyndromes(unsigned char*, unsigned char*, unsigned char*);
 
 int CountC2Errors(unsigned char*);
 
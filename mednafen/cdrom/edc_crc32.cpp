@@ -23,6 +23,15 @@
 
 #include "dvdisaster.h"
 
+#if defined(ARCH_X86) && defined(__GNUC__)
+#define EDC_CLMUL_X86
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRYPTO)
+#define EDC_CLMUL_ARM
+#include <arm_neon.h>
+#endif
+
 /***
  *** EDC checksum used in CDROM sectors
  ***/
@@ -115,6 +124,162 @@ static const unsigned long  edctable[256] =
  0x71C0FC00L, 0xE151FD01L, 0xE0E1FE01L, 0x7070FF00L
 };
 
+/*
+ * Slicing-by-8 tables, derived from edctable[]:
+ * slice[k][i] is the CRC of byte i followed by k zero bytes.
+ */
+
+static class EDCTables
+{
+ public:
+  EDCTables();
+
+  uint32_t slice[8][256];
+  bool use_clmul;
+} EDC;
+
+EDCTables::EDCTables()
+{
+ for(int i = 0; i < 256; i++)
+  slice[0][i] = edctable[i];
+
+ for(int k = 1; k < 8; k++)
+  for(int i = 0; i < 256; i++)
+   slice[k][i] = (slice[k - 1][i] >> 8) ^ slice[0][slice[k - 1][i] & 0xFF];
+
+ use_clmul = false;
+#if defined(EDC_CLMUL_X86)
+ __builtin_cpu_init();
+ use_clmul = __builtin_cpu_supports("pclmul");
+#elif defined(EDC_CLMUL_ARM)
+ use_clmul = true;
+#endif
+}
+
+static uint32_t EDCCrc32_Slice8(uint32_t crc, const unsigned char *data, int len)
+{
+ while(len >= 8)
+ {
+  const uint32_t one = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24));
+  const uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24);
+
+  crc = EDC.slice[7][one & 0xFF] ^ EDC.slice[6][(one >> 8) & 0xFF] ^ EDC.slice[5][(one >> 16) & 0xFF] ^ EDC.slice[4][one >> 24] ^
+        EDC.slice[3][two & 0xFF] ^ EDC.slice[2][(two >> 8) & 0xFF] ^ EDC.slice[1][(two >> 16) & 0xFF] ^ EDC.slice[0][two >> 24];
+
+  data += 8;
+  len -= 8;
+ }
+
+ while(len--)
+  crc = EDC.slice[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+
+ return crc;
+}
+
+/*
+ * Carry-less multiply folding(see Intel's "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction"), bit-reflected.
+ *
+ * Folds len bytes(a multiple of 16, at least 64) with crc xor'd into the first
+ * four into 16 bytes at out, whose CRC(starting from 0) is the CRC of the
+ * whole; that leaves the final reduction to the table code.
+ *
+ * The constants are x^n mod P(x) for P(x) = 0x18001801B, bit-reflected over 33 bits:
+ *  n = 4*128+32, 4*128-32 for folding four blocks at a time,
+ *  n = 128+32, 128-32 for one block.
+ */
+#if defined(EDC_CLMUL_X86) || defined(EDC_CLMUL_ARM)
+static const uint64_t EDC_K1 = 0x1F8931102ULL, EDC_K2 = 0x12E7928A2ULL;
+static const uint64_t EDC_K3 = 0x06C90C100ULL, EDC_K4 = 0x1D5934102ULL;
+#endif
+
+#if defined(EDC_CLMUL_X86)
+static inline __attribute__((target("sse2,pclmul"))) __m128i EDC_Fold(__m128i x, __m128i k, __m128i next)
+{
+ return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), next);
+}
+
+static __attribute__((target("sse2,pclmul"))) void EDCCrc32_Fold(uint32_t crc, const unsigned char *data, int len, unsigned char *out)
+{
+ const __m128i k12 = _mm_set_epi64x(EDC_K2, EDC_K1);
+ const __m128i k34 = _mm_set_epi64x(EDC_K4, EDC_K3);
+ __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)data), _mm_cvtsi32_si128(crc));
+ __m128i x1 = _mm_loadu_si128((const __m128i *)(data + 16));
+ __m128i x2 = _mm_loadu_si128((const __m128i *)(data + 32));
+ __m128i x3 = _mm_loadu_si128((const __m128i *)(data + 48));
+
+ data += 64;
+ len -= 64;
+
+ while(len >= 64)
+ {
+  x0 = EDC_Fold(x0, k12, _mm_loadu_si128((const __m128i *)data));
+  x1 = EDC_Fold(x1, k12, _mm_loadu_si128((const __m128i *)(data + 16)));
+  x2 = EDC_Fold(x2, k12, _mm_loadu_si128((const __m128i *)(data + 32)));
+  x3 = EDC_Fold(x3, k12, _mm_loadu_si128((const __m128i *)(data + 48)));
+  data += 64;
+  len -= 64;
+ }
+
+ x0 = EDC_Fold(x0, k34, x1);
+ x0 = EDC_Fold(x0, k34, x2);
+ x0 = EDC_Fold(x0, k34, x3);
+
+ while(len >= 16)
+ {
+  x0 = EDC_Fold(x0, k34, _mm_loadu_si128((const __m128i *)data));
+  data += 16;
+  len -= 16;
+ }
+
+ _mm_storeu_si128((__m128i *)out, x0);
+}
+#elif defined(EDC_CLMUL_ARM)
+static inline uint64x2_t EDC_Fold(uint64x2_t x, uint64x2_t k, uint64x2_t next)
+{
+ const uint64x2_t lo = vreinterpretq_u64_p128(vmull_p64((poly64_t)vgetq_lane_u64(x, 0), (poly64_t)vgetq_lane_u64(k, 0)));
+ const uint64x2_t hi = vreinterpretq_u64_p128(vmull_high_p64(vreinterpretq_p64_u64(x), vreinterpretq_p64_u64(k)));
+
+ return veorq_u64(veorq_u64(lo, hi), next);
+}
+
+static void EDCCrc32_Fold(uint32_t crc, const unsigned char *data, int len, unsigned char *out)
+{
+ const uint64x2_t k12 = vcombine_u64(vcreate_u64(EDC_K1), vcreate_u64(EDC_K2));
+ const uint64x2_t k34 = vcombine_u64(vcreate_u64(EDC_K3), vcreate_u64(EDC_K4));
+ uint64x2_t x0 = veorq_u64(vld1q_u64((const uint64_t *)data), vcombine_u64(vcreate_u64(crc), vcreate_u64(0)));
+ uint64x2_t x1 = vld1q_u64((const uint64_t *)(data + 16));
+ uint64x2_t x2 = vld1q_u64((const uint64_t *)(data + 32));
+ uint64x2_t x3 = vld1q_u64((const uint64_t *)(data + 48));
+
+ data += 64;
+ len -= 64;
+
+ while(len >= 64)
+ {
+  x0 = EDC_Fold(x0, k12, vld1q_u64((const uint64_t *)data));
+  x1 = EDC_Fold(x1, k12, vld1q_u64((const uint64_t *)(data + 16)));
+  x2 = EDC_Fold(x2, k12, vld1q_u64((const uint64_t *)(data + 32)));
+  x3 = EDC_Fold(x3, k12, vld1q_u64((const uint64_t *)(data + 48)));
+  data += 64;
+  len -= 64;
+ }
+
+ x0 = EDC_Fold(x0, k34, x1);
+ x0 = EDC_Fold(x0, k34, x2);
+ x0 = EDC_Fold(x0, k34, x3);
+
+ while(len >= 16)
+ {
+  x0 = EDC_Fold(x0, k34, vld1q_u64((const uint64_t *)data));
+  data += 16;
+  len -= 16;
+ }
+
+ vst1q_u64((uint64_t *)out, x0);
+}
+#endif
+
 /*
  * CDROM EDC calculation
  */
@@ -123,8 +288,19 @@ uint32_t EDCCrc32(const unsigned char *data, int len)
 {  
  uint32_t crc = 0;
 
- while(len--)
-  crc = edctable[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+#if defined(EDC_CLMUL_X86) || defined(EDC_CLMUL_ARM)
+ if(EDC.use_clmul && len >= 64)
+ {
+  const int fold_len = len & ~15;
+  unsigned char folded[16];
 
- return crc;
+  EDCCrc32_Fold(crc, data, fold_len, folded);
+  crc = EDCCrc32_Slice8(0, folded, 16);
+
+  data += fold_len;
+  len -= fold_len;
+ }
+#endif
+
+ return EDCCrc32_Slice8(crc, data, len);
 }
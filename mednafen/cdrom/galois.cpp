@@ -26,6 +26,16 @@
 
 #include "galois-inlines.h"
 
+#if defined(ARCH_X86) && defined(__GNUC__)
+#define GALOIS_SSSE3
+#include <tmmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define GALOIS_NEON
+#include <arm_neon.h>
+#endif
+
 /***
  *** Galois field arithmetic.
  *** 
@@ -82,6 +92,141 @@ void FreeGaloisTables(GaloisTables *gt)
   free(gt);
 }
 
+/***
+ *** Multiply-accumulate by constants, 16 symbols at a time
+ ***/
+
+/* Shift-and-add multiplication, for building the tables */
+
+static int32_t galois_mult(int32_t gf_generator, int32_t a, int32_t b)
+{  int32_t p = 0;
+
+   while(b)
+   {  if(b & 1)
+	p ^= a;
+      a <<= 1;
+      if(a & GF_FIELDSIZE)
+	a ^= gf_generator;
+      b >>= 1;
+   }
+
+   return p;
+}
+
+void CreateGaloisMulTable2(GaloisMulTable2 *mt, int32_t gf_generator, int32_t c0, int32_t c1)
+{  int32_t x;
+
+   for(x=0; x<16; x++)
+   {  mt->lo[0][x] = galois_mult(gf_generator, c0, x);
+      mt->hi[0][x] = galois_mult(gf_generator, c0, x << 4);
+      mt->lo[1][x] = galois_mult(gf_generator, c1, x);
+      mt->hi[1][x] = galois_mult(gf_generator, c1, x << 4);
+   }
+
+   for(x=0; x<256; x++)
+     mt->full[x] =  (mt->lo[0][x & 15] ^ mt->hi[0][x >> 4])
+                 | ((mt->lo[1][x & 15] ^ mt->hi[1][x >> 4]) << 8);
+}
+
+#ifdef GALOIS_SSSE3
+static __attribute__((target("ssse3"))) void GaloisMulSum2_SSSE3(uint8_t *acc0, uint8_t *acc1, const uint8_t *src, int stride,
+								 const GaloisMulTable2 *t, int rows, int len)
+{  const __m128i nib = _mm_set1_epi8(0x0F);
+   int i,r;
+
+   for(i=0; i<len; i+=16)
+   {  __m128i a0 = _mm_setzero_si128();
+      __m128i a1 = _mm_setzero_si128();
+
+      for(r=0; r<rows; r++)
+      {  const __m128i d = _mm_loadu_si128((const __m128i *)(src + r*stride + i));
+	 const __m128i dl = _mm_and_si128(d, nib);
+	 const __m128i dh = _mm_and_si128(_mm_srli_epi16(d, 4), nib);
+
+	 a0 = _mm_xor_si128(a0, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)t[r].lo[0]), dl));
+	 a0 = _mm_xor_si128(a0, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)t[r].hi[0]), dh));
+	 a1 = _mm_xor_si128(a1, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)t[r].lo[1]), dl));
+	 a1 = _mm_xor_si128(a1, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)t[r].hi[1]), dh));
+      }
+
+      _mm_storeu_si128((__m128i *)(acc0 + i), a0);
+      _mm_storeu_si128((__m128i *)(acc1 + i), a1);
+   }
+}
+
+static bool HaveSSSE3(void)
+{  __builtin_cpu_init();
+   return __builtin_cpu_supports("ssse3");
+}
+
+static const bool UseSSSE3 = HaveSSSE3();
+#endif
+
+#ifdef GALOIS_NEON
+static inline uint8x16_t GaloisLookup(const uint8_t *table, uint8x16_t idx)
+{
+#if defined(__aarch64__)
+   return vqtbl1q_u8(vld1q_u8(table), idx);
+#else
+   uint8x8x2_t t2;
+
+   t2.val[0] = vld1_u8(table);
+   t2.val[1] = vld1_u8(table + 8);
+
+   return vcombine_u8(vtbl2_u8(t2, vget_low_u8(idx)), vtbl2_u8(t2, vget_high_u8(idx)));
+#endif
+}
+#endif
+
+/*
+ * acc0[i] = sum of c0(t[r]) * src[r*stride + i] over all rows r, and acc1[i]
+ * likewise with c1(t[r]), for i below len rounded up to a multiple of 16;
+ * acc0, acc1 and each source row must be that large.
+ */
+
+void GaloisMulSum2(uint8_t *acc0, uint8_t *acc1, const uint8_t *src, int stride,
+		   const GaloisMulTable2 *t, int rows, int len)
+{  int i,r;
+
+#if defined(GALOIS_SSSE3)
+   if(UseSSSE3)
+   {  GaloisMulSum2_SSSE3(acc0, acc1, src, stride, t, rows, len);
+      return;
+   }
+#elif defined(GALOIS_NEON)
+   {  const uint8x16_t nib = vdupq_n_u8(0x0F);
+
+      for(i=0; i<len; i+=16)
+      {  uint8x16_t a0 = vdupq_n_u8(0);
+	 uint8x16_t a1 = vdupq_n_u8(0);
+
+	 for(r=0; r<rows; r++)
+	 {  const uint8x16_t d = vld1q_u8(src + r*stride + i);
+	    const uint8x16_t dl = vandq_u8(d, nib);
+	    const uint8x16_t dh = vshrq_n_u8(d, 4);
+
+	    a0 = veorq_u8(a0, veorq_u8(GaloisLookup(t[r].lo[0], dl), GaloisLookup(t[r].hi[0], dh)));
+	    a1 = veorq_u8(a1, veorq_u8(GaloisLookup(t[r].lo[1], dl), GaloisLookup(t[r].hi[1], dh)));
+	 }
+
+	 vst1q_u8(acc0 + i, a0);
+	 vst1q_u8(acc1 + i, a1);
+      }
+      return;
+   }
+#endif
+
+   for(i=0; i<len; i++)
+   {  uint16_t a = 0;
+
+      for(r=0; r<rows; r++)
+	a ^= t[r].full[src[r*stride + i]];
+
+      acc0[i] = a & 0xFF;
+      acc1[i] = a >> 8;
+   }
+}
+
 /***
  *** Create the the Reed-Solomon generator polynomial
  *** and some auxiliary data structures.
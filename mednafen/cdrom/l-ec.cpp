@@ -28,6 +28,10 @@
 
 #include <retro_miscellaneous.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 /***
  *** Mapping between cd frame and parity vectors
  ***/
@@ -138,6 +142,60 @@ void GetQVector(unsigned char *frame, unsigned char *data, int n)
    data[44] = frame[2300 + n];
 }
 
+/*
+ * Element i of all 52 Q vectors, i.e. data[n] = Q vector n's data[i].
+ * data must have room for 64 bytes.
+ */
+
+#ifdef __SSE2__
+/* Offset of row m % 26 */
+static const int16_t QRowOffset[52] =
+{  0*86,  1*86,  2*86,  3*86,  4*86,  5*86,  6*86,  7*86,  8*86,  9*86, 10*86, 11*86, 12*86,
+  13*86, 14*86, 15*86, 16*86, 17*86, 18*86, 19*86, 20*86, 21*86, 22*86, 23*86, 24*86, 25*86,
+   0*86,  1*86,  2*86,  3*86,  4*86,  5*86,  6*86,  7*86,  8*86,  9*86, 10*86, 11*86, 12*86,
+  13*86, 14*86, 15*86, 16*86, 17*86, 18*86, 19*86, 20*86, 21*86, 22*86, 23*86, 24*86, 25*86
+};
+#endif
+
+void GetQVectorsElement(unsigned char *frame, unsigned char *data, int i)
+{
+   if(i == 43) { memcpy(data, frame + 2248, N_Q_VECTORS); return; }
+   if(i == 44) { memcpy(data, frame + 2300, N_Q_VECTORS); return; }
+
+#ifdef __SSE2__
+   /* Q vectors 2m and 2m+1 take their element i from the byte pair
+      in column i of row (m + i) % 26 */
+   {  const unsigned char *col = frame + 12 + 2*i;
+      const int16_t *ro = QRowOffset + (i % 26);
+      int v;
+
+      for(v=0; v<4; v++, ro+=8)
+      {  __m128i x = _mm_setzero_si128();
+
+#define QINS(k) { uint16_t w; memcpy(&w, col + ro[k], 2); x = _mm_insert_epi16(x, w, k); }
+	 QINS(0); QINS(1);
+	 if(v < 3)
+	 {  QINS(2); QINS(3); QINS(4); QINS(5); QINS(6); QINS(7);
+	 }
+#undef QINS
+	 _mm_storeu_si128((__m128i *)(data + 16*v), x);
+      }
+   }
+#else
+   {  const unsigned char *src = frame + 12 + (i * 88) % 2236;
+      const unsigned char *wrap = frame + 12 + 2236;
+      int n;
+
+      /* Byte pairs 86 apart, wrapping around once */
+      for(n=0; n<N_Q_VECTORS && src < wrap; n+=2, src+=86)
+	memcpy(data + n, src, 2);
+
+      for(src-=2236; n<N_Q_VECTORS; n+=2, src+=86)
+	memcpy(data + n, src, 2);
+   }
+#endif
+}
+
 void SetQVector(unsigned char *frame, unsigned char *data, int n)
 {  int offset = 12 + (n & 1);
    int w_idx  = (n&~1) * 43;
@@ -222,6 +280,41 @@ int CountC2Errors(unsigned char *frame)
 #define LEC_PRIM_ELEM 1
 #define LEC_PRIMTH_ROOT 1
 
+/*
+ * Calculate the error syndromes of all P or Q vectors at once.
+ * s0[n] and s1[n] are the syndromes DecodePQ() would compute for vector n,
+ * i.e. the sums of its elements weighted with alpha**0 and alpha**(size-1-i);
+ * both being zero means the vector is fine. s0 and s1 need room for 96 bytes.
+ */
+
+static GaloisMulTable2 PSyndromeMul[P_VECTOR_SIZE];
+static GaloisMulTable2 QSyndromeMul[Q_VECTOR_SIZE];
+
+void InitPQSyndromes(GaloisTables *gt)
+{  int i;
+
+   for(i=0; i<P_VECTOR_SIZE; i++)
+     CreateGaloisMulTable2(&PSyndromeMul[i], gt->gfGenerator, 1, gt->alphaTo[P_VECTOR_SIZE-1-i]);
+
+   for(i=0; i<Q_VECTOR_SIZE; i++)
+     CreateGaloisMulTable2(&QSyndromeMul[i], gt->gfGenerator, 1, gt->alphaTo[Q_VECTOR_SIZE-1-i]);
+}
+
+void CalcPSyndromes(unsigned char *frame, unsigned char *s0, unsigned char *s1)
+{
+   GaloisMulSum2(s0, s1, frame + 12, 86, PSyndromeMul, P_VECTOR_SIZE, N_P_VECTORS);
+}
+
+void CalcQSyndromes(unsigned char *frame, unsigned char *s0, unsigned char *s1)
+{  unsigned char data[Q_VECTOR_SIZE][64];
+   int i;
+
+   for(i=0; i<Q_VECTOR_SIZE; i++)
+     GetQVectorsElement(frame, data[i], i);
+
+   GaloisMulSum2(s0, s1, data[0], 64, QSyndromeMul, Q_VECTOR_SIZE, N_Q_VECTORS);
+}
+
 /*
  * Calculate the error syndrome
  */
@@ -19,13 +19,13 @@
 
 
 #include <stdint.h>
+#include <string.h>
 
 #include "lec.h"
+#include "dvdisaster.h"
 
 #define GF8_PRIM_POLY 0x11d /* x^8 + x^4 + x^3 + x^2 + 1 */
 
-#define EDC_POLY 0x8001801b /* (x^16 + x^15 + x^2 + 1) (x^16 + x^2 + x + 1) */
-
 #define LEC_HEADER_OFFSET 12
 #define LEC_DATA_OFFSET 16
 #define LEC_MODE1_DATA_LEN 2048
@@ -46,24 +46,13 @@ static gf8_t GF8_ILOG[256];
 
 static const class Gf8_Q_Coeffs_Results_01 {
 private:
-  uint16_t table[43][256];
+  GaloisMulTable2 table[43];
 public:
   Gf8_Q_Coeffs_Results_01();
   ~Gf8_Q_Coeffs_Results_01() {}
-  const uint16_t *operator[] (int i) const { return &table[i][0]; }
-  operator const uint16_t *() const	    { return &table[0][0]; }
+  const GaloisMulTable2 *operator[] (int i) const { return &table[i]; }
 } CF8_Q_COEFFS_RESULTS_01;
 
-static const class CrcTable {
-private:
-  uint32_t table[256];
-public:
-  CrcTable();
-  ~CrcTable() {}
-  uint32_t operator[](int i) const	{ return table[i]; }
-  operator const uint32_t *() const	{ return table;    }
-} CRCTABLE;
-
 static const class ScrambleTable {
 private:
   uint8_t table[2340];
@@ -192,92 +181,19 @@ Gf8_Q_Coeffs_Results_01::Gf8_Q_Coeffs_Results_01()
   }
 
   /* 
-   * Compute the products of 0..255 with all of the Q coefficients in
+   * Compute the products of all nibbles with the Q coefficients in
    * advance. When building the scalar product between the data vectors
    * and the P/Q vectors the individual products can be looked up in
-   * this table
+   * these tables, 16 at a time (see GaloisMulSum2())
    *
    * The P parity coefficients are just a subset of the Q coefficients so
    * that we do not need to create a separate table for them. 
    */
   
   for (j = 0; j < 43; j++) {
-
-    table[j][0] = 0;
-
-    for (i = 1; i < 256; i++) {
-      c = GF8_LOG[i] + GF8_LOG[GF8_Q_COEFFS[0][j]];
-      if (c >= 255) c -= 255;
-      table[j][i] = GF8_ILOG[c];
-
-      c = GF8_LOG[i] + GF8_LOG[GF8_Q_COEFFS[1][j]];
-      if (c >= 255) c -= 255;
-      table[j][i] |= GF8_ILOG[c]<<8;
-    }
-  }
-}
-
-/* Reverses the bits in 'd'. 'bits' defines the bit width of 'd'.
- */
-static uint32_t mirror_bits(uint32_t d, int bits)
-{
-  int i;
-  uint32_t r = 0;
-
-  for (i = 0; i < bits; i++) {
-    r <<= 1;
-
-    if ((d & 0x1) != 0)
-      r |= 0x1;
-
-    d >>= 1;
-  }
-
-  return r;
-}
-
-/* Build the CRC lookup table for EDC_POLY poly. The CRC is 32 bit wide
- * and reversed (i.e. the bit stream is divided by the EDC_POLY with the
- * LSB first order).
- */
-CrcTable::CrcTable ()
-{
-  uint32_t i, j;
-  uint32_t r;
-  
-  for (i = 0; i < 256; i++) {
-    r = mirror_bits(i, 8);
-
-    r <<= 24;
-
-    for (j = 0; j < 8; j++) {
-      if ((r & 0x80000000) != 0) {
-	r <<= 1;
-	r ^= EDC_POLY;
-      }
-      else {
-	r <<= 1;
-      }
-    }
-
-    r = mirror_bits(r, 32);
-
-    table[i] = r;
-  }
-}
-
-/* Calculates the CRC of given data with given lengths based on the
- * table lookup algorithm.
- */
-static uint32_t calc_edc(uint8_t *data, int len)
-{
-  uint32_t crc = 0;
-
-  while (len--) {
-    crc = CRCTABLE[(int)(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    CreateGaloisMulTable2(&table[j], GF8_PRIM_POLY,
+                          GF8_Q_COEFFS[0][j], GF8_Q_COEFFS[1][j]);
   }
-
-  return crc;
 }
 
 /* Build the scramble table as defined in the yellow book. The bytes
@@ -315,7 +231,7 @@ ScrambleTable::ScrambleTable()
  */
 static void calc_mode1_edc(uint8_t *sector)
 {
-  uint32_t crc = calc_edc(sector, LEC_MODE1_DATA_LEN + 16);
+  uint32_t crc = EDCCrc32(sector, LEC_MODE1_DATA_LEN + 16);
 
   sector[LEC_MODE1_EDC_OFFSET] = crc & 0xffL;
   sector[LEC_MODE1_EDC_OFFSET + 1] = (crc >> 8) & 0xffL;
@@ -327,7 +243,7 @@ static void calc_mode1_edc(uint8_t *sector)
  */
 static void calc_mode2_form1_edc(uint8_t *sector)
 {
-  uint32_t crc = calc_edc(sector + LEC_DATA_OFFSET,
+  uint32_t crc = EDCCrc32(sector + LEC_DATA_OFFSET,
 			   LEC_MODE2_FORM1_DATA_LEN);
 
   sector[LEC_MODE2_FORM1_EDC_OFFSET] = crc & 0xffL;
@@ -340,7 +256,7 @@ static void calc_mode2_form1_edc(uint8_t *sector)
  */
 static void calc_mode2_form2_edc(uint8_t *sector)
 {
-  uint32_t crc = calc_edc(sector + LEC_DATA_OFFSET,
+  uint32_t crc = EDCCrc32(sector + LEC_DATA_OFFSET,
 			   LEC_MODE2_FORM2_DATA_LEN);
 
   sector[LEC_MODE2_FORM2_EDC_OFFSET] = crc & 0xffL;
@@ -382,44 +298,14 @@ static void set_sector_header(uint8_t mode, uint32_t adr, uint8_t *sector)
  */
 static void calc_P_parity(uint8_t *sector)
 {
-  int i, j;
-  uint16_t p01_msb, p01_lsb;
-  uint8_t *p_lsb_start;
-  uint8_t *p_lsb;
-  uint8_t *p0, *p1;
-  uint8_t d0,d1;
-
-  p_lsb_start = sector + LEC_HEADER_OFFSET;
-
-  p1 = sector + LEC_MODE1_P_PARITY_OFFSET;
-  p0 = sector + LEC_MODE1_P_PARITY_OFFSET + 2 * 43;
-
-  for (i = 0; i <= 42; i++) {
-    p_lsb = p_lsb_start;
-
-    p01_lsb = p01_msb = 0;
+  uint8_t p0[96], p1[96];
 
-    for (j = 19; j <= 42; j++) {
-      d0 = *p_lsb;
-      d1 = *(p_lsb+1);
+  /* All 86 vectors at once; row j - 19 is combined with coefficient j */
+  GaloisMulSum2(p0, p1, sector + LEC_HEADER_OFFSET, 2 * 43,
+		CF8_Q_COEFFS_RESULTS_01[19], 24, 2 * 43);
 
-      p01_lsb ^= CF8_Q_COEFFS_RESULTS_01[j][d0];
-      p01_msb ^= CF8_Q_COEFFS_RESULTS_01[j][d1];
-
-      p_lsb += 2 * 43;
-    }
-
-    *p0 = p01_lsb;
-    *(p0 + 1) = p01_msb;
-    
-    *p1 = p01_lsb>>8;
-    *(p1 + 1) = p01_msb>>8;
-
-    p0 += 2;
-    p1 += 2;
-
-    p_lsb_start += 2;
-  }
+  memcpy(sector + LEC_MODE1_P_PARITY_OFFSET + 2 * 43, p0, 2 * 43);
+  memcpy(sector + LEC_MODE1_P_PARITY_OFFSET, p1, 2 * 43);
 }
 
 /* Calculate the Q parities for the sector.
@@ -427,49 +313,18 @@ static void calc_P_parity(uint8_t *sector)
  */
 static void calc_Q_parity(uint8_t *sector)
 {
-  int i, j;
-  uint16_t q01_lsb, q01_msb;
-  uint8_t *q_lsb_start;
-  uint8_t *q_lsb;
-  uint8_t *q0, *q1, *q_start;
-  uint8_t d0,d1;
-
-  q_lsb_start = sector + LEC_HEADER_OFFSET;
-
-  q_start = sector + LEC_MODE1_Q_PARITY_OFFSET;
-  q1 = sector + LEC_MODE1_Q_PARITY_OFFSET;
-  q0 = sector + LEC_MODE1_Q_PARITY_OFFSET + 2 * 26;
+  int j;
+  uint8_t q0[64], q1[64];
+  uint8_t d[43][64];
 
-  for (i = 0; i <= 25; i++) {
-    q_lsb = q_lsb_start;
+  /* All 52 vectors at once, after gathering element j of each into d[j] */
+  for (j = 0; j <= 42; j++)
+    GetQVectorsElement(sector, d[j], j);
 
-    q01_lsb = q01_msb = 0;
+  GaloisMulSum2(q0, q1, d[0], 64, CF8_Q_COEFFS_RESULTS_01[0], 43, 2 * 26);
 
-    for (j = 0; j <= 42; j++) {
-      d0 = *q_lsb;
-      d1 = *(q_lsb+1);
-
-      q01_lsb ^= CF8_Q_COEFFS_RESULTS_01[j][d0];
-      q01_msb ^= CF8_Q_COEFFS_RESULTS_01[j][d1];
-
-      q_lsb += 2 * 44;
-
-      if (q_lsb >= q_start) {
-	q_lsb -= 2 * 1118;
-      }
-    }
-
-    *q0 = q01_lsb;
-    *(q0 + 1) = q01_msb;
-    
-    *q1 = q01_lsb>>8;
-    *(q1 + 1) = q01_msb>>8;
-
-    q0 += 2;
-    q1 += 2;
-
-    q_lsb_start += 2 * 43;
-  }
+  memcpy(sector + LEC_MODE1_Q_PARITY_OFFSET + 2 * 26, q0, 2 * 26);
+  memcpy(sector + LEC_MODE1_Q_PARITY_OFFSET, q1, 2 * 26);
 }
 
 /* Encodes a MODE 0 sector.
@@ -515,6 +370,17 @@ void lec_encode_mode1_sector(uint32_t adr, uint8_t *sector)
   calc_Q_parity(sector);
 }
 
+/* Sets sync pattern and header of a MODE 1 sector, leaving the EDC and
+ * L-EC fields untouched.
+ * 'adr' is the current physical sector address
+ * 'sector' must be 2352 byte wide
+ */
+void lec_encode_mode1_header(uint32_t adr, uint8_t *sector)
+{
+  set_sync_pattern(sector);
+  set_sector_header(1, adr, sector);
+}
+
 /* Encodes a MODE 2 sector.
  * 'adr' is the current physical sector address
  * 'sector' must be 2352 byte wide containing 2336 bytes user data at
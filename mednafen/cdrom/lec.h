@@ -35,6 +35,13 @@ void lec_encode_mode0_sector(uint32_t adr, uint8_t *sector);
  */
 void lec_encode_mode1_sector(uint32_t adr, uint8_t *sector);
 
+/* Sets sync pattern and header of a MODE 1 sector, leaving the EDC and
+ * L-EC fields untouched.
+ * 'adr' is the current physical sector address
+ * 'sector' must be 2352 byte wide
+ */
+void lec_encode_mode1_header(uint32_t adr, uint8_t *sector);
+
 /* Encodes a MODE 2 sector.
  * 'adr' is the current physical sector address
  * 'sector' must be 2352 byte wide containing 2336 bytes user data at
@@ -29,6 +29,7 @@ bool Init_LEC_Correct(void)
 {
  gt = CreateGaloisTables(0x11d);
  rt = CreateReedSolomonTables(gt, 0, 1, 10);
+ InitPQSyndromes(gt);
 
  return(1);
 }
@@ -86,6 +87,7 @@ static int simple_lec(unsigned char *frame)
    unsigned char p_vector[P_VECTOR_SIZE];
    unsigned char q_vector[Q_VECTOR_SIZE];
    unsigned char p_state[P_VECTOR_SIZE];
+   unsigned char syn0[96], syn1[96];
    int erasures[Q_VECTOR_SIZE], erasure_count;
    int ignore[2];
    int p_failures, q_failures;
@@ -101,9 +103,16 @@ static int simple_lec(unsigned char *frame)
 
    /* Perform Q-Parity error correction */
 
+   CalcQSyndromes(frame, syn0, syn1);
+
    for(q=0; q<N_Q_VECTORS; q++)
    {  int err;
 
+      /* Nothing for DecodePQ() to do if the syndromes are zero */
+
+      if(!(syn0[q] | syn1[q]))
+	continue;
+
       /* We have no erasure information for Q vectors */
 
      GetQVector(frame, q_vector, q);
@@ -125,9 +134,14 @@ static int simple_lec(unsigned char *frame)
 
    /* Perform P-Parity error correction */
 
+   CalcPSyndromes(frame, syn0, syn1);
+
    for(p=0; p<N_P_VECTORS; p++)
    {  int err,i;
 
+      if(!(syn0[p] | syn1[p]))
+	continue;
+
       /* Try error correction without erasure information */
 
       GetPVector(frame, p_vector, p);
@@ -24,6 +24,9 @@
 #if defined(__SSE2__)
 #include <xmmintrin.h>
 #include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SCSICD_NEON
+#include <arm_neon.h>
 #endif
 
 #include "../mednafen.h"
@@ -308,10 +311,7 @@ static void GenSubQFromSubPW(void)
 {
  uint8_t SubQBuf[0xC];
 
- memset(SubQBuf, 0, 0xC);
-
- for(int i = 0; i < 96; i++)
-  SubQBuf[i >> 3] |= ((cd.SubPWBuf[i] & 0x40) >> 6) << (7 - (i & 7));
+ subq_deinterleave(cd.SubPWBuf, SubQBuf);
 
  //printf("Real %d/ SubQ %d - ", read_sec, BCD_to_U8(SubQBuf[7]) * 75 * 60 + BCD_to_U8(SubQBuf[8]) * 75 + BCD_to_U8(SubQBuf[9]) - 150);
  // Debug code, remove me.
@@ -1403,6 +1403,7 @@ static void DoREADHEADER10(const uint8_t *cdb)
  uint32_t HeaderLBA = MDFN_de32msb(cdb + 0x2);
  int AllocSize = MDFN_de16msb(cdb + 0x7);
  uint8_t raw_buf[2352 + 96];
+ bool synth = false;
  uint8_t mode;
  int m, s, f;
  uint32_t lba;
@@ -1427,8 +1428,8 @@ static void DoREADHEADER10(const uint8_t *cdb)
   return;
  }
 
- Cur_CDIF->ReadRawSector(raw_buf, HeaderLBA);	//, HeaderLBA + 1);
- if(!ValidateRawDataSector(raw_buf, HeaderLBA))
+ Cur_CDIF->ReadRawSector(raw_buf, HeaderLBA, &synth);	//, HeaderLBA + 1);
+ if(!synth && !ValidateRawDataSector(raw_buf, HeaderLBA))
   return;
 
  m = BCD_to_U8(raw_buf[12 + 0]);
@@ -1505,7 +1506,7 @@ static void DoPABase(const uint32_t lba, const uint32_t length, unsigned int sta
 
   if(read_sec < toc.tracks[100].lba)
   {
-   Cur_CDIF->HintReadSector(read_sec);	//, read_sec_end, read_sec_start);
+   Cur_CDIF->HintReadSector(read_sec, read_sec_end - read_sec);
   }
  }
 
@@ -1894,7 +1895,7 @@ static void DoREADBase(uint32_t sa, uint32_t sc)
  SectorCount = sc;
  if(SectorCount)
  {
-  Cur_CDIF->HintReadSector(sa);	//, sa + sc);
+  Cur_CDIF->HintReadSector(sa, sc);
 
   CDReadTimer = (uint64_t)((WhichSystem == SCSICD_PCE) ? 3 : 1) * 2048 * System_Clock / CD_DATA_TRANSFER_RATE;
  }
@@ -2386,23 +2387,142 @@ static const int16_t OversampleFilter[2][0x10] =
  {    -43,    138,   -323,    645,  -1176,   2074,  -3844,   9724,  29464,  -5661,   2783,  -1562,    877,   -463,    217,    -82,  }, /* sum=32768, sum_abs=59076 */
 };
 
+// Output samples RunCDDA() collects before adding them into HRBufs in one pass.
+#define CDDA_SYNTH_BATCH	256
+
+static void SynthCDDA(const uint32_t* synthtime_ex_batch, const int32_t (*sample_va_batch)[2], const unsigned count)
+{
+ //
+ // FINAL_OUT_SHIFT should be 32 so we can take advantage of 32x32->64 multipliers on 32-bit CPUs.
+ //
+ #define FINAL_OUT_SHIFT 32
+ #define MULT_SHIFT_ADJ (32 - (26 + (8 - CDDA_FILTER_NUMPHASES_SHIFT)))
+
+ #if (((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 0) << MULT_SHIFT_ADJ) > 32767
+  #error "COEFF MULT OVERFLOW"
+ #endif
+
+#if defined(__SSE2__)
+ const __m128i hi_mask = _mm_set_epi32(-1, 0, -1, 0);
+#endif
+
+ for(unsigned i = 0; i < count; i++)
+ {
+  const uint32_t synthtime_ex = synthtime_ex_batch[i];
+  const int32_t* sample_va = sample_va_batch[i];
+  const int synthtime = (synthtime_ex >> 16) & 0xFFFF;	// & 0xFFFF(or equivalent) to prevent overflowing HRBufs[]
+  const int synthtime_phase = (int)(synthtime_ex & 0xFFFF) - 0x80;
+  const int synthtime_phase_int = synthtime_phase >> (16 - CDDA_FILTER_NUMPHASES_SHIFT);
+  const int synthtime_phase_fract = synthtime_phase & ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 1);
+  const int16_t mult_a = ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - synthtime_phase_fract) << MULT_SHIFT_ADJ;
+  const int16_t mult_b = synthtime_phase_fract << MULT_SHIFT_ADJ;
+  const int16_t* fa = CDDA_Filter[1 + synthtime_phase_int + 0];
+  const int16_t* fb = CDDA_Filter[1 + synthtime_phase_int + 1];
+
+  //if(synthtime_phase_fract == 0)
+  // printf("%5d: %d %d\n", synthtime_phase_fract, mult_a, mult_b);
+
+  //
+  // All 8 taps of the interpolated filter(the padding tap's coefficient works out to 0) are handled at once.  The coefficients are never
+  // negative, which lets the SSE2 path get the high half of the signed 32x32->64 product out of the unsigned multiply.
+  //
+#if defined(__SSE2__)
+  const __m128i ra = _mm_loadu_si128((const __m128i*)fa);
+  const __m128i rb = _mm_loadu_si128((const __m128i*)fb);
+  const __m128i mults = _mm_set1_epi32((uint16_t)mult_a | ((uint32_t)(uint16_t)mult_b << 16));
+  const __m128i coeff[2] = { _mm_madd_epi16(_mm_unpacklo_epi16(ra, rb), mults), _mm_madd_epi16(_mm_unpackhi_epi16(ra, rb), mults) };
+
+  for(unsigned lr = 0; lr < 2; lr++)
+  {
+   const __m128i sv = _mm_set1_epi32(sample_va[lr]);
+   const __m128i sv_neg = _mm_srai_epi32(sv, 31);
+   int32_t* tb = &HRBufs[lr][synthtime];
+
+   for(unsigned h = 0; h < 2; h++)
+   {
+    const __m128i prod_even = _mm_mul_epu32(coeff[h], sv);
+    const __m128i prod_odd = _mm_mul_epu32(_mm_srli_epi64(coeff[h], 32), sv);
+    __m128i hi = _mm_or_si128(_mm_srli_epi64(prod_even, 32), _mm_and_si128(prod_odd, hi_mask));
+
+    hi = _mm_sub_epi32(hi, _mm_and_si128(coeff[h], sv_neg));
+    _mm_storeu_si128((__m128i*)&tb[h * 4], _mm_add_epi32(_mm_loadu_si128((__m128i*)&tb[h * 4]), hi));
+   }
+  }
+#elif defined(SCSICD_NEON)
+  const int16x8_t ra = vld1q_s16(fa);
+  const int16x8_t rb = vld1q_s16(fb);
+  const int32x4_t coeff[2] = { vmlal_n_s16(vmull_n_s16(vget_low_s16(ra), mult_a), vget_low_s16(rb), mult_b),
+			       vmlal_n_s16(vmull_n_s16(vget_high_s16(ra), mult_a), vget_high_s16(rb), mult_b) };
+
+  for(unsigned lr = 0; lr < 2; lr++)
+  {
+   int32_t* tb = &HRBufs[lr][synthtime];
+
+   for(unsigned h = 0; h < 2; h++)
+   {
+    const int32x4_t hi = vcombine_s32(vshrn_n_s64(vmull_n_s32(vget_low_s32(coeff[h]), sample_va[lr]), FINAL_OUT_SHIFT),
+				      vshrn_n_s64(vmull_n_s32(vget_high_s32(coeff[h]), sample_va[lr]), FINAL_OUT_SHIFT));
+
+    vst1q_s32(&tb[h * 4], vaddq_s32(vld1q_s32(&tb[h * 4]), hi));
+   }
+  }
+#else
+  int32_t coeff[CDDA_FILTER_NUMCONVOLUTIONS];
+
+  for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
+  {
+   coeff[c] = (fa[c] * mult_a + fb[c] * mult_b);
+  }
+
+  int32_t* tb0 = &HRBufs[0][synthtime];
+  int32_t* tb1 = &HRBufs[1][synthtime];
+
+  for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
+  {
+   tb0[c] += ((int64_t)coeff[c] * sample_va[0]) >> FINAL_OUT_SHIFT;
+   tb1[c] += ((int64_t)coeff[c] * sample_va[1]) >> FINAL_OUT_SHIFT;
+  }
+#endif
+ }
+ #undef FINAL_OUT_SHIFT
+ #undef MULT_SHIFT_ADJ
+}
+
 static INLINE void RunCDDA(uint32_t system_timestamp, int32_t run_time)
 {
  if(cdda.CDDAStatus == CDDASTATUS_PLAYING || cdda.CDDAStatus == CDDASTATUS_SCANNING)
  {
+  uint32_t synthtime_ex_batch[CDDA_SYNTH_BATCH];
+  int32_t sample_va_batch[CDDA_SYNTH_BATCH][2];
+  unsigned batch_count = 0;
+
   cdda.CDDADiv -= (int64_t)run_time << 20;
 
+  //
+  // synthtime_ex is ((system_timestamp << 20) + CDDADiv) / CDDATimeDiv, and CDDADiv only ever steps by CDDADivAcc in the loop below, so
+  // divide once and then step the quotient and remainder instead.
+  //
+  const uint64_t synthtime_num = ((uint64_t)system_timestamp << 20) + (int64_t)cdda.CDDADiv;
+  const uint32_t acc_quot = cdda.CDDADivAcc / cdda.CDDATimeDiv;
+  const uint32_t acc_rem = cdda.CDDADivAcc % cdda.CDDATimeDiv;
+  uint64_t synthtime_quot = synthtime_num / cdda.CDDATimeDiv;
+  uint32_t synthtime_rem = synthtime_num % cdda.CDDATimeDiv;
+
   while(cdda.CDDADiv <= 0)
   {
-   const uint32_t synthtime_ex = (((uint64_t)system_timestamp << 20) + (int64_t)cdda.CDDADiv) / cdda.CDDATimeDiv;
-   const int synthtime = (synthtime_ex >> 16) & 0xFFFF;	// & 0xFFFF(or equivalent) to prevent overflowing HRBufs[]
-   const int synthtime_phase = (int)(synthtime_ex & 0xFFFF) - 0x80;
-   const int synthtime_phase_int = synthtime_phase >> (16 - CDDA_FILTER_NUMPHASES_SHIFT);
-   const int synthtime_phase_fract = synthtime_phase & ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 1);
-   int32_t sample_va[2];
+   const uint32_t synthtime_ex = synthtime_quot;
+   int32_t* sample_va = sample_va_batch[batch_count];
 
    cdda.CDDADiv += cdda.CDDADivAcc;
 
+   synthtime_quot += acc_quot;
+   synthtime_rem += acc_rem;
+   if(synthtime_rem >= (uint32_t)cdda.CDDATimeDiv)
+   {
+    synthtime_quot++;
+    synthtime_rem -= cdda.CDDATimeDiv;
+   }
+
    if(!(cdda.OversamplePos & 1))
    {
     if(cdda.CDDAReadPos == 588)
@@ -2613,45 +2733,19 @@ static INLINE void RunCDDA(uint32_t system_timestamp, int32_t run_time)
    }
 
 
-   if(HRBufs[0] && HRBufs[1])
+   synthtime_ex_batch[batch_count] = synthtime_ex;
+   if(++batch_count == CDDA_SYNTH_BATCH)
    {
-    //
-    // FINAL_OUT_SHIFT should be 32 so we can take advantage of 32x32->64 multipliers on 32-bit CPUs.
-    //
-    #define FINAL_OUT_SHIFT 32
-    #define MULT_SHIFT_ADJ (32 - (26 + (8 - CDDA_FILTER_NUMPHASES_SHIFT)))
-
-    #if (((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - 0) << MULT_SHIFT_ADJ) > 32767
-     #error "COEFF MULT OVERFLOW"
-    #endif
-
-    const int16_t mult_a = ((1 << (16 - CDDA_FILTER_NUMPHASES_SHIFT)) - synthtime_phase_fract) << MULT_SHIFT_ADJ;
-    const int16_t mult_b = synthtime_phase_fract << MULT_SHIFT_ADJ;
-    int32_t coeff[CDDA_FILTER_NUMCONVOLUTIONS];
-
-    //if(synthtime_phase_fract == 0)
-    // printf("%5d: %d %d\n", synthtime_phase_fract, mult_a, mult_b);
-
-    for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
-    {
-     coeff[c] = (CDDA_Filter[1 + synthtime_phase_int + 0][c] * mult_a + 
-		 CDDA_Filter[1 + synthtime_phase_int + 1][c] * mult_b);
-    }
-
-    int32_t* tb0 = &HRBufs[0][synthtime];
-    int32_t* tb1 = &HRBufs[1][synthtime];
-
-    for(unsigned c = 0; c < CDDA_FILTER_NUMCONVOLUTIONS; c++)
-    {
-     tb0[c] += ((int64_t)coeff[c] * sample_va[0]) >> FINAL_OUT_SHIFT;
-     tb1[c] += ((int64_t)coeff[c] * sample_va[1]) >> FINAL_OUT_SHIFT;
-    }
-    #undef FINAL_OUT_SHIFT
-    #undef MULT_SHIFT_ADJ
+    if(HRBufs[0] && HRBufs[1])
+     SynthCDDA(synthtime_ex_batch, sample_va_batch, batch_count);
+    batch_count = 0;
    }
 
    cdda.OversamplePos = (cdda.OversamplePos + 1) & 0x1F;
   } // end while(cdda.CDDADiv <= 0)
+
+  if(batch_count && HRBufs[0] && HRBufs[1])
+   SynthCDDA(synthtime_ex_batch, sample_va_batch, batch_count);
  }
 }
 
@@ -2675,6 +2769,7 @@ static INLINE void RunCDRead(uint32_t system_timestamp, int32_t run_time)
    else
    {
     uint8_t tmp_read_buf[2352 + 96];
+    bool synth = false;
 
     if(TrayOpen)
     {
@@ -2691,13 +2786,13 @@ static INLINE void RunCDRead(uint32_t system_timestamp, int32_t run_time)
     {
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST, NSE_END_OF_VOLUME);
     }
-    else if(!Cur_CDIF->ReadRawSector(tmp_read_buf, SectorAddr))	//, SectorAddr + SectorCount))
+    else if(!Cur_CDIF->ReadRawSector(tmp_read_buf, SectorAddr, &synth))	//, SectorAddr + SectorCount))
     {
      cd.data_transfer_done = FALSE;
 
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST);
     }
-    else if(ValidateRawDataSector(tmp_read_buf, SectorAddr))
+    else if(synth || ValidateRawDataSector(tmp_read_buf, SectorAddr))
     {
      memcpy(cd.SubPWBuf, tmp_read_buf + 2352, 96);
 
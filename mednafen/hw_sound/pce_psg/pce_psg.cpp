@@ -77,6 +77,10 @@ INLINE void PCE_PSG::UpdateOutputSub(const int32 timestamp, psg_channel *ch, con
  delta[0] = samp0 - ch->blip_prev_samp[0];
  delta[1] = samp1 - ch->blip_prev_samp[1];
 
+ // Most steps of a noise channel, and of a waveform with repeated samples, don't change the output.
+ if(!(delta[0] | delta[1]))
+  return;
+
  const int16* c = Phase_Filter[(timestamp >> 1) & 1];
  const int32 l = (timestamp >> 2) & 0xFFFF;
 
@@ -100,51 +104,53 @@ INLINE void PCE_PSG::UpdateOutputSub(const int32 timestamp, psg_channel *ch, con
  ch->blip_prev_samp[1] = samp1;
 }
 
-void PCE_PSG::UpdateOutput_Norm(const int32 timestamp, psg_channel *ch)
+// Called for every waveform step and noise clock, so dispatch on the output mode here rather than through a member function pointer
+// the compiler can't see through.
+INLINE void PCE_PSG::UpdateOutput(const int32 timestamp, psg_channel *ch)
 {
- int sv = ch->dda;
-
- UpdateOutputSub(timestamp, ch, dbtable[ch->vl[0]][sv],
- 				dbtable[ch->vl[1]][sv]);
-}
-
-void PCE_PSG::UpdateOutput_Noise(const int32 timestamp, psg_channel *ch)
-{
- int sv = ((ch->lfsr & 1) << 5) - (ch->lfsr & 1); //(ch->lfsr & 0x1) ? 0x1F : 0;
-
- UpdateOutputSub(timestamp, ch, dbtable[ch->vl[0]][sv],
-				dbtable[ch->vl[1]][sv]);
-}
+ switch(ch->output_mode)
+ {
+  default:
+  case OUTPUT_OFF:
+	UpdateOutputSub(timestamp, ch, 0, 0);
+	break;
 
-void PCE_PSG::UpdateOutput_Off(const int32 timestamp, psg_channel *ch)
-{
- UpdateOutputSub(timestamp, ch, 0, 0);
-}
+  case OUTPUT_NORM:
+	{
+	 int sv = ch->dda;
 
-void PCE_PSG::UpdateOutput_Accum_HuC6280A(const int32 timestamp, psg_channel *ch)
-{
- int32 samp[2];
+	 UpdateOutputSub(timestamp, ch, dbtable[ch->vl[0]][sv],
+					dbtable[ch->vl[1]][sv]);
+	}
+	break;
 
- // 31(5-bit max) * 32 samples = 992
- // 992 / 2 = 496
- // 
- // 8 + 5 = 13
- // 13 - 12 = 1
+  case OUTPUT_NOISE:
+	{
+	 int sv = ((ch->lfsr & 1) << 5) - (ch->lfsr & 1); //(ch->lfsr & 0x1) ? 0x1F : 0;
 
- samp[0] = ((int32)dbtable_volonly[ch->vl[0]] * ((int32)ch->samp_accum - 496)) >> (8 + 5);
- samp[1] = ((int32)dbtable_volonly[ch->vl[1]] * ((int32)ch->samp_accum - 496)) >> (8 + 5);
+	 UpdateOutputSub(timestamp, ch, dbtable[ch->vl[0]][sv],
+					dbtable[ch->vl[1]][sv]);
+	}
+	break;
 
- UpdateOutputSub(timestamp, ch, samp[0], samp[1]);
-}
+  case OUTPUT_ACCUM:
+	{
+	 int32 samp[2];
 
-void PCE_PSG::UpdateOutput_Accum_HuC6280(const int32 timestamp, psg_channel *ch)
-{
- int32 samp[2];
+	 // 31(5-bit max) * 32 samples = 992
+	 // 992 / 2 = 496
+	 // 
+	 // 8 + 5 = 13
+	 // 13 - 12 = 1
+	 const int32 accum = (revision == REVISION_HUC6280) ? (int32)ch->samp_accum : ((int32)ch->samp_accum - 496);
 
- samp[0] = ((int32)dbtable_volonly[ch->vl[0]] * (int32)ch->samp_accum) >> (8 + 5);
- samp[1] = ((int32)dbtable_volonly[ch->vl[1]] * (int32)ch->samp_accum) >> (8 + 5);
+	 samp[0] = ((int32)dbtable_volonly[ch->vl[0]] * accum) >> (8 + 5);
+	 samp[1] = ((int32)dbtable_volonly[ch->vl[1]] * accum) >> (8 + 5);
 
- UpdateOutputSub(timestamp, ch, samp[0], samp[1]);
+	 UpdateOutputSub(timestamp, ch, samp[0], samp[1]);
+	}
+	break;
+ }
 }
 
 
@@ -154,15 +160,15 @@ void PCE_PSG::RecalcUOFunc(int chnum)
  psg_channel *ch = &channel[chnum];
 
  if((revision != REVISION_HUC6280 && !(ch->control & 0xC0)) || (revision == REVISION_HUC6280 && !(ch->control & 0x80)))
-  ch->UpdateOutput = &PCE_PSG::UpdateOutput_Off;
+  ch->output_mode = OUTPUT_OFF;
  else if(ch->noisectrl & ch->control & 0x80)
-  ch->UpdateOutput = &PCE_PSG::UpdateOutput_Noise;
+  ch->output_mode = OUTPUT_NOISE;
  // If the control for the channel is in waveform play mode, and the (real) playback frequency is too high, and the channel is either not the LFO modulator channel or
  // if the LFO trigger bit(which halts the LFO modulator channel's waveform incrementing when set) is clear
  else if((ch->control & 0xC0) == 0x80 && ch->freq_cache <= FREQC7M_COT && (chnum != 1 || !(lfoctrl & 0x80)) )
-  ch->UpdateOutput = UpdateOutput_Accum;
+  ch->output_mode = OUTPUT_ACCUM;
  else
-  ch->UpdateOutput = &PCE_PSG::UpdateOutput_Norm;
+  ch->output_mode = OUTPUT_NORM;
 }
 
 
@@ -402,20 +408,9 @@ void PSG_SetRegister(const unsigned int id, const uint32 value)
 PCE_PSG::PCE_PSG(int32* hr_l, int32* hr_r, int want_revision)
 {
 	revision = want_revision;
-	switch(revision)
-	{
-	 default:
-		abort();
-		break;
-
-	 case REVISION_HUC6280:
-		UpdateOutput_Accum = &PCE_PSG::UpdateOutput_Accum_HuC6280;
-		break;
+	if(revision != REVISION_HUC6280 && revision != REVISION_HUC6280A)
+	 abort();
 
-	 case REVISION_HUC6280A:
-		UpdateOutput_Accum = &PCE_PSG::UpdateOutput_Accum_HuC6280A;
-		break;
-	}
 	HRBufs[0] = hr_l;
 	HRBufs[1] = hr_r;
 
@@ -591,7 +586,7 @@ void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
  if(!run_time)
   return;
 
- (this->*ch->UpdateOutput)(running_timestamp, ch);
+ UpdateOutput(running_timestamp, ch);
 
  if(chc >= 4)
  {
@@ -599,11 +594,11 @@ void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
 
   ch->noisecount -= run_time;
 
-  if(&PCE_PSG::UpdateOutput_Noise == ch->UpdateOutput)
+  if(ch->output_mode == OUTPUT_NOISE)
    while(ch->noisecount <= 0)
    {
     CLOCK_LFSR(ch->lfsr);
-    UpdateOutput_Noise(timestamp + ch->noisecount, ch);
+    UpdateOutput(timestamp + ch->noisecount, ch);
     ch->noisecount += freq;
    }
   else
@@ -642,7 +637,7 @@ void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
   ch->waveform_index = (ch->waveform_index + 1) & 0x1F;
   ch->dda = ch->waveform[ch->waveform_index];
 
-  (this->*ch->UpdateOutput)(timestamp + ch->counter, ch);
+  UpdateOutput(timestamp + ch->counter, ch);
 
   if(LFO_On)
   {
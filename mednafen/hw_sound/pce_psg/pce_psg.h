@@ -15,7 +15,7 @@ struct psg_channel
 
         int32 counter;
 
-        void (PCE_PSG::*UpdateOutput)(const int32 timestamp, psg_channel *ch);
+        uint8 output_mode;      // PCE_PSG::OUTPUT_*, selected by RecalcUOFunc()
 
         uint32 freq_cache;
         uint32 noise_freq_cache;        // Channel 4,5 only
@@ -131,14 +131,17 @@ class PCE_PSG
 	void UpdateSubLFO(int32 timestamp);
 	void UpdateSubNonLFO(int32 timestamp);
 
+	enum
+	{
+	 OUTPUT_OFF = 0,
+	 OUTPUT_NORM,
+	 OUTPUT_NOISE,
+	 OUTPUT_ACCUM
+	};
+
 	void RecalcUOFunc(int chnum);
         void UpdateOutputSub(const int32 timestamp, psg_channel *ch, const int32 samp0, const int32 samp1);
-	void UpdateOutput_Off(const int32 timestamp, psg_channel *ch);
-	void UpdateOutput_Accum_HuC6280(const int32 timestamp, psg_channel *ch);
-	void UpdateOutput_Accum_HuC6280A(const int32 timestamp, psg_channel *ch);
-        void UpdateOutput_Norm(const int32 timestamp, psg_channel *ch);
-        void UpdateOutput_Noise(const int32 timestamp, psg_channel *ch);
-        void (PCE_PSG::*UpdateOutput_Accum)(const int32 timestamp, psg_channel *ch);
+        void UpdateOutput(const int32 timestamp, psg_channel *ch);
 
 	int32 GetVL(const int chnum, const int lr);
 
@@ -23,6 +23,23 @@
 #include "../mednafen-types.h"
 #include "jrevdct.h"
 
+#include <libretro.h>
+
+#if defined(__SSE2__)
+#define JREVDCT_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(ARCH_X86) && defined(__GNUC__)
+#define JREVDCT_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define JREVDCT_NEON
+#include <arm_neon.h>
+#endif
+
 /*
  * This routine is specialized to the case DCTSIZE = 8.
  */
@@ -278,3 +295,451 @@ void j_rev_dct(DCTBLOCK data)
     dataptr++;			/* advance pointer to next column */
   }
 }
+
+/*
+ * Shortcut for a block whose only nonzero coefficient is the DC term:
+ * every output sample is the same, so run the DC value through the two
+ * descaling steps once and fill the block with it.
+ */
+
+void j_rev_dct_dc(DCTBLOCK data)
+{
+  const int32 pass1 = DESCALE((int32) data[0] << CONST_BITS, CONST_BITS-PASS1_BITS);
+  const DCTELEM dc = (DCTELEM) DESCALE(pass1 << CONST_BITS, CONST_BITS+PASS1_BITS+1);
+  int i;
+
+  for (i = 0; i < DCTSIZE*DCTSIZE; i++)
+    data[i] = dc;
+}
+
+/*
+ * Shortcut for a block whose rows 4-7 are all zero, which is the case
+ * whenever the last nonzero coefficient in zigzag order is at position 9
+ * or earlier.  An all-zero row stays all-zero through pass 1, so only rows
+ * 0-3 are transformed; pass 2 is then j_rev_dct()'s column pass with the
+ * y4..y7 terms dropped.
+ */
+
+void j_rev_dct_sparse(DCTBLOCK data)
+{
+  int32 tmp0, tmp1, tmp2, tmp3;
+  int32 tmp10, tmp11, tmp12, tmp13;
+  int32 z1, z2, z3, z4, z5;
+  register DCTELEM *dataptr;
+  int rowctr;
+
+  /* Pass 1: process rows 0-3, as in j_rev_dct(). */
+
+  dataptr = data;
+  for (rowctr = 3; rowctr >= 0; rowctr--)
+  {
+    z2 = (int32) dataptr[2];
+    z3 = (int32) dataptr[6];
+
+    z1 = MULTIPLY(z2 + z3, FIX_0_541196100);
+    tmp2 = z1 + MULTIPLY(z3, - FIX_1_847759065);
+    tmp3 = z1 + MULTIPLY(z2, FIX_0_765366865);
+
+    tmp0 = ((int32) dataptr[0] + (int32) dataptr[4]) << CONST_BITS;
+    tmp1 = ((int32) dataptr[0] - (int32) dataptr[4]) << CONST_BITS;
+
+    tmp10 = tmp0 + tmp3;
+    tmp13 = tmp0 - tmp3;
+    tmp11 = tmp1 + tmp2;
+    tmp12 = tmp1 - tmp2;
+
+    tmp0 = (int32) dataptr[7];
+    tmp1 = (int32) dataptr[5];
+    tmp2 = (int32) dataptr[3];
+    tmp3 = (int32) dataptr[1];
+
+    z1 = tmp0 + tmp3;
+    z2 = tmp1 + tmp2;
+    z3 = tmp0 + tmp2;
+    z4 = tmp1 + tmp3;
+    z5 = MULTIPLY(z3 + z4, FIX_1_175875602);
+
+    tmp0 = MULTIPLY(tmp0, FIX_0_298631336);
+    tmp1 = MULTIPLY(tmp1, FIX_2_053119869);
+    tmp2 = MULTIPLY(tmp2, FIX_3_072711026);
+    tmp3 = MULTIPLY(tmp3, FIX_1_501321110);
+    z1 = MULTIPLY(z1, - FIX_0_899976223);
+    z2 = MULTIPLY(z2, - FIX_2_562915447);
+    z3 = MULTIPLY(z3, - FIX_1_961570560);
+    z4 = MULTIPLY(z4, - FIX_0_390180644);
+
+    z3 += z5;
+    z4 += z5;
+
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    dataptr[0] = (DCTELEM) DESCALE(tmp10 + tmp3, CONST_BITS-PASS1_BITS);
+    dataptr[7] = (DCTELEM) DESCALE(tmp10 - tmp3, CONST_BITS-PASS1_BITS);
+    dataptr[1] = (DCTELEM) DESCALE(tmp11 + tmp2, CONST_BITS-PASS1_BITS);
+    dataptr[6] = (DCTELEM) DESCALE(tmp11 - tmp2, CONST_BITS-PASS1_BITS);
+    dataptr[2] = (DCTELEM) DESCALE(tmp12 + tmp1, CONST_BITS-PASS1_BITS);
+    dataptr[5] = (DCTELEM) DESCALE(tmp12 - tmp1, CONST_BITS-PASS1_BITS);
+    dataptr[3] = (DCTELEM) DESCALE(tmp13 + tmp0, CONST_BITS-PASS1_BITS);
+    dataptr[4] = (DCTELEM) DESCALE(tmp13 - tmp0, CONST_BITS-PASS1_BITS);
+
+    dataptr += DCTSIZE;
+  }
+
+  /* Pass 2: process columns, with y4 = y5 = y6 = y7 = 0. */
+
+  dataptr = data;
+  for (rowctr = DCTSIZE-1; rowctr >= 0; rowctr--) {
+    z2 = (int32) dataptr[DCTSIZE*2];
+
+    z1 = MULTIPLY(z2, FIX_0_541196100);
+    tmp2 = z1;
+    tmp3 = z1 + MULTIPLY(z2, FIX_0_765366865);
+
+    tmp0 = ((int32) dataptr[DCTSIZE*0]) << CONST_BITS;
+
+    tmp10 = tmp0 + tmp3;
+    tmp13 = tmp0 - tmp3;
+    tmp11 = tmp0 + tmp2;
+    tmp12 = tmp0 - tmp2;
+
+    tmp2 = (int32) dataptr[DCTSIZE*3];
+    tmp3 = (int32) dataptr[DCTSIZE*1];
+
+    z5 = MULTIPLY(tmp2 + tmp3, FIX_1_175875602);
+
+    z1 = MULTIPLY(tmp3, - FIX_0_899976223);
+    z2 = MULTIPLY(tmp2, - FIX_2_562915447);
+    z3 = MULTIPLY(tmp2, - FIX_1_961570560) + z5;
+    z4 = MULTIPLY(tmp3, - FIX_0_390180644) + z5;
+
+    tmp0 = z1 + z3;
+    tmp1 = z2 + z4;
+    tmp2 = MULTIPLY(tmp2, FIX_3_072711026) + z2 + z3;
+    tmp3 = MULTIPLY(tmp3, FIX_1_501321110) + z1 + z4;
+
+    dataptr[DCTSIZE*0] = (DCTELEM) DESCALE(tmp10 + tmp3, CONST_BITS+PASS1_BITS+1);
+    dataptr[DCTSIZE*7] = (DCTELEM) DESCALE(tmp10 - tmp3, CONST_BITS+PASS1_BITS+1);
+    dataptr[DCTSIZE*1] = (DCTELEM) DESCALE(tmp11 + tmp2, CONST_BITS+PASS1_BITS+1);
+    dataptr[DCTSIZE*6] = (DCTELEM) DESCALE(tmp11 - tmp2, CONST_BITS+PASS1_BITS+1);
+    dataptr[DCTSIZE*2] = (DCTELEM) DESCALE(tmp12 + tmp1, CONST_BITS+PASS1_BITS+1);
+    dataptr[DCTSIZE*5] = (DCTELEM) DESCALE(tmp12 - tmp1, CONST_BITS+PASS1_BITS+1);
+    dataptr[DCTSIZE*3] = (DCTELEM) DESCALE(tmp13 + tmp0, CONST_BITS+PASS1_BITS+1);
+    dataptr[DCTSIZE*4] = (DCTELEM) DESCALE(tmp13 - tmp0, CONST_BITS+PASS1_BITS+1);
+
+    dataptr++;
+  }
+}
+
+/*
+ * SIMD versions of j_rev_dct().  The block is transposed so that pass 1
+ * becomes a column pass as well, and each vector lane then runs the scalar
+ * algorithm on one row or column(see jrevdct_1d.inc), giving bit-identical
+ * output.
+ */
+
+#if defined(JREVDCT_SSE2)
+static INLINE __m128i jrevdct_mul_sse2(__m128i a, const int32 c)
+{
+  /* SSE2 has no 32-bit low multiply; the low halves of the unsigned
+     64-bit products are the same bits a signed multiply would give. */
+  const __m128i cv = _mm_set1_epi32(c);
+  __m128i even = _mm_mul_epu32(a, cv);
+  __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), cv);
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+static INLINE void jrevdct_1d_sse2(__m128i *v, const int shift)
+{
+  const __m128i round = _mm_set1_epi32(ONE << (shift - 1));
+  const __m128i count = _mm_cvtsi32_si128(shift);
+
+#define JV __m128i
+#define JV_ADD(a,b) _mm_add_epi32(a, b)
+#define JV_SUB(a,b) _mm_sub_epi32(a, b)
+#define JV_MUL(a,c) jrevdct_mul_sse2(a, c)
+#define JV_SHL(a) _mm_slli_epi32(a, CONST_BITS)
+#define JV_DESCALE(a) _mm_sra_epi32(_mm_add_epi32(a, round), count)
+#include "jrevdct_1d.inc"
+#undef JV
+#undef JV_ADD
+#undef JV_SUB
+#undef JV_MUL
+#undef JV_SHL
+#undef JV_DESCALE
+}
+
+static INLINE void jrevdct_transpose4_sse2(__m128i *a, __m128i *b, __m128i *c, __m128i *d)
+{
+  const __m128i t0 = _mm_unpacklo_epi32(*a, *b);
+  const __m128i t1 = _mm_unpacklo_epi32(*c, *d);
+  const __m128i t2 = _mm_unpackhi_epi32(*a, *b);
+  const __m128i t3 = _mm_unpackhi_epi32(*c, *d);
+
+  *a = _mm_unpacklo_epi64(t0, t1);
+  *b = _mm_unpackhi_epi64(t0, t1);
+  *c = _mm_unpacklo_epi64(t2, t3);
+  *d = _mm_unpackhi_epi64(t2, t3);
+}
+
+/* lo[] holds columns 0-3 of each row, hi[] columns 4-7. */
+static INLINE void jrevdct_transpose_sse2(__m128i *lo, __m128i *hi)
+{
+  __m128i t;
+
+  jrevdct_transpose4_sse2(&lo[0], &lo[1], &lo[2], &lo[3]);
+  jrevdct_transpose4_sse2(&hi[0], &hi[1], &hi[2], &hi[3]);
+  jrevdct_transpose4_sse2(&lo[4], &lo[5], &lo[6], &lo[7]);
+  jrevdct_transpose4_sse2(&hi[4], &hi[5], &hi[6], &hi[7]);
+
+  t = hi[0]; hi[0] = lo[4]; lo[4] = t;
+  t = hi[1]; hi[1] = lo[5]; lo[5] = t;
+  t = hi[2]; hi[2] = lo[6]; lo[6] = t;
+  t = hi[3]; hi[3] = lo[7]; lo[7] = t;
+}
+
+static void j_rev_dct_sse2(DCTBLOCK data)
+{
+  __m128i lo[8], hi[8];
+
+  lo[0] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*0 + 0]);
+  hi[0] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*0 + 4]);
+  lo[1] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*1 + 0]);
+  hi[1] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*1 + 4]);
+  lo[2] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*2 + 0]);
+  hi[2] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*2 + 4]);
+  lo[3] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*3 + 0]);
+  hi[3] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*3 + 4]);
+  lo[4] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*4 + 0]);
+  hi[4] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*4 + 4]);
+  lo[5] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*5 + 0]);
+  hi[5] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*5 + 4]);
+  lo[6] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*6 + 0]);
+  hi[6] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*6 + 4]);
+  lo[7] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*7 + 0]);
+  hi[7] = _mm_loadu_si128((const __m128i *)&data[DCTSIZE*7 + 4]);
+
+  jrevdct_transpose_sse2(lo, hi);
+  jrevdct_1d_sse2(lo, CONST_BITS-PASS1_BITS);
+  jrevdct_1d_sse2(hi, CONST_BITS-PASS1_BITS);
+  jrevdct_transpose_sse2(lo, hi);
+  jrevdct_1d_sse2(lo, CONST_BITS+PASS1_BITS+1);
+  jrevdct_1d_sse2(hi, CONST_BITS+PASS1_BITS+1);
+
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*0 + 0], lo[0]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*0 + 4], hi[0]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*1 + 0], lo[1]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*1 + 4], hi[1]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*2 + 0], lo[2]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*2 + 4], hi[2]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*3 + 0], lo[3]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*3 + 4], hi[3]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*4 + 0], lo[4]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*4 + 4], hi[4]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*5 + 0], lo[5]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*5 + 4], hi[5]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*6 + 0], lo[6]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*6 + 4], hi[6]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*7 + 0], lo[7]);
+  _mm_storeu_si128((__m128i *)&data[DCTSIZE*7 + 4], hi[7]);
+}
+#endif
+
+#if defined(JREVDCT_AVX2)
+#define JREVDCT_AVX2_FUNC static INLINE __attribute__((target("avx2")))
+
+JREVDCT_AVX2_FUNC void jrevdct_1d_avx2(__m256i *v, const int shift)
+{
+  const __m256i round = _mm256_set1_epi32(ONE << (shift - 1));
+  const __m128i count = _mm_cvtsi32_si128(shift);
+
+#define JV __m256i
+#define JV_ADD(a,b) _mm256_add_epi32(a, b)
+#define JV_SUB(a,b) _mm256_sub_epi32(a, b)
+#define JV_MUL(a,c) _mm256_mullo_epi32(a, _mm256_set1_epi32(c))
+#define JV_SHL(a) _mm256_slli_epi32(a, CONST_BITS)
+#define JV_DESCALE(a) _mm256_sra_epi32(_mm256_add_epi32(a, round), count)
+#include "jrevdct_1d.inc"
+#undef JV
+#undef JV_ADD
+#undef JV_SUB
+#undef JV_MUL
+#undef JV_SHL
+#undef JV_DESCALE
+}
+
+JREVDCT_AVX2_FUNC void jrevdct_transpose_avx2(__m256i *r)
+{
+  const __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+  const __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+  const __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+  const __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+  const __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+  const __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+  const __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+  const __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+  const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+  const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+  const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+  const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+  const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+  const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+  const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+  const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+  r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+  r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+  r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+  r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+  r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+  r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+  r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+  r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+static __attribute__((target("avx2"))) void j_rev_dct_avx2(DCTBLOCK data)
+{
+  __m256i v[8];
+
+  v[0] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*0]);
+  v[1] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*1]);
+  v[2] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*2]);
+  v[3] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*3]);
+  v[4] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*4]);
+  v[5] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*5]);
+  v[6] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*6]);
+  v[7] = _mm256_loadu_si256((const __m256i *)&data[DCTSIZE*7]);
+
+  jrevdct_transpose_avx2(v);
+  jrevdct_1d_avx2(v, CONST_BITS-PASS1_BITS);
+  jrevdct_transpose_avx2(v);
+  jrevdct_1d_avx2(v, CONST_BITS+PASS1_BITS+1);
+
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*0], v[0]);
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*1], v[1]);
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*2], v[2]);
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*3], v[3]);
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*4], v[4]);
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*5], v[5]);
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*6], v[6]);
+  _mm256_storeu_si256((__m256i *)&data[DCTSIZE*7], v[7]);
+}
+#endif
+
+#if defined(JREVDCT_NEON)
+static INLINE void jrevdct_1d_neon(int32x4_t *v, const int shift)
+{
+  const int32x4_t round = vdupq_n_s32(ONE << (shift - 1));
+  const int32x4_t count = vdupq_n_s32(-shift);
+
+#define JV int32x4_t
+#define JV_ADD(a,b) vaddq_s32(a, b)
+#define JV_SUB(a,b) vsubq_s32(a, b)
+#define JV_MUL(a,c) vmulq_n_s32(a, c)
+#define JV_SHL(a) vshlq_n_s32(a, CONST_BITS)
+#define JV_DESCALE(a) vshlq_s32(vaddq_s32(a, round), count)
+#include "jrevdct_1d.inc"
+#undef JV
+#undef JV_ADD
+#undef JV_SUB
+#undef JV_MUL
+#undef JV_SHL
+#undef JV_DESCALE
+}
+
+static INLINE void jrevdct_transpose4_neon(int32x4_t *a, int32x4_t *b, int32x4_t *c, int32x4_t *d)
+{
+  const int32x4x2_t p0 = vtrnq_s32(*a, *b);
+  const int32x4x2_t p1 = vtrnq_s32(*c, *d);
+
+  *a = vcombine_s32(vget_low_s32(p0.val[0]), vget_low_s32(p1.val[0]));
+  *b = vcombine_s32(vget_low_s32(p0.val[1]), vget_low_s32(p1.val[1]));
+  *c = vcombine_s32(vget_high_s32(p0.val[0]), vget_high_s32(p1.val[0]));
+  *d = vcombine_s32(vget_high_s32(p0.val[1]), vget_high_s32(p1.val[1]));
+}
+
+/* lo[] holds columns 0-3 of each row, hi[] columns 4-7. */
+static INLINE void jrevdct_transpose_neon(int32x4_t *lo, int32x4_t *hi)
+{
+  int32x4_t t;
+
+  jrevdct_transpose4_neon(&lo[0], &lo[1], &lo[2], &lo[3]);
+  jrevdct_transpose4_neon(&hi[0], &hi[1], &hi[2], &hi[3]);
+  jrevdct_transpose4_neon(&lo[4], &lo[5], &lo[6], &lo[7]);
+  jrevdct_transpose4_neon(&hi[4], &hi[5], &hi[6], &hi[7]);
+
+  t = hi[0]; hi[0] = lo[4]; lo[4] = t;
+  t = hi[1]; hi[1] = lo[5]; lo[5] = t;
+  t = hi[2]; hi[2] = lo[6]; lo[6] = t;
+  t = hi[3]; hi[3] = lo[7]; lo[7] = t;
+}
+
+static void j_rev_dct_neon(DCTBLOCK data)
+{
+  int32x4_t lo[8], hi[8];
+
+  lo[0] = vld1q_s32(&data[DCTSIZE*0 + 0]);
+  hi[0] = vld1q_s32(&data[DCTSIZE*0 + 4]);
+  lo[1] = vld1q_s32(&data[DCTSIZE*1 + 0]);
+  hi[1] = vld1q_s32(&data[DCTSIZE*1 + 4]);
+  lo[2] = vld1q_s32(&data[DCTSIZE*2 + 0]);
+  hi[2] = vld1q_s32(&data[DCTSIZE*2 + 4]);
+  lo[3] = vld1q_s32(&data[DCTSIZE*3 + 0]);
+  hi[3] = vld1q_s32(&data[DCTSIZE*3 + 4]);
+  lo[4] = vld1q_s32(&data[DCTSIZE*4 + 0]);
+  hi[4] = vld1q_s32(&data[DCTSIZE*4 + 4]);
+  lo[5] = vld1q_s32(&data[DCTSIZE*5 + 0]);
+  hi[5] = vld1q_s32(&data[DCTSIZE*5 + 4]);
+  lo[6] = vld1q_s32(&data[DCTSIZE*6 + 0]);
+  hi[6] = vld1q_s32(&data[DCTSIZE*6 + 4]);
+  lo[7] = vld1q_s32(&data[DCTSIZE*7 + 0]);
+  hi[7] = vld1q_s32(&data[DCTSIZE*7 + 4]);
+
+  jrevdct_transpose_neon(lo, hi);
+  jrevdct_1d_neon(lo, CONST_BITS-PASS1_BITS);
+  jrevdct_1d_neon(hi, CONST_BITS-PASS1_BITS);
+  jrevdct_transpose_neon(lo, hi);
+  jrevdct_1d_neon(lo, CONST_BITS+PASS1_BITS+1);
+  jrevdct_1d_neon(hi, CONST_BITS+PASS1_BITS+1);
+
+  vst1q_s32(&data[DCTSIZE*0 + 0], lo[0]);
+  vst1q_s32(&data[DCTSIZE*0 + 4], hi[0]);
+  vst1q_s32(&data[DCTSIZE*1 + 0], lo[1]);
+  vst1q_s32(&data[DCTSIZE*1 + 4], hi[1]);
+  vst1q_s32(&data[DCTSIZE*2 + 0], lo[2]);
+  vst1q_s32(&data[DCTSIZE*2 + 4], hi[2]);
+  vst1q_s32(&data[DCTSIZE*3 + 0], lo[3]);
+  vst1q_s32(&data[DCTSIZE*3 + 4], hi[3]);
+  vst1q_s32(&data[DCTSIZE*4 + 0], lo[4]);
+  vst1q_s32(&data[DCTSIZE*4 + 4], hi[4]);
+  vst1q_s32(&data[DCTSIZE*5 + 0], lo[5]);
+  vst1q_s32(&data[DCTSIZE*5 + 4], hi[5]);
+  vst1q_s32(&data[DCTSIZE*6 + 0], lo[6]);
+  vst1q_s32(&data[DCTSIZE*6 + 4], hi[6]);
+  vst1q_s32(&data[DCTSIZE*7 + 0], lo[7]);
+  vst1q_s32(&data[DCTSIZE*7 + 4], hi[7]);
+}
+#endif
+
+/*
+ * Pick the fastest full transform for the host CPU; cpuext is a
+ * RETRO_SIMD_* mask from the frontend, or 0 if it isn't known.
+ */
+
+j_rev_dct_func j_rev_dct_select(uint64 cpuext)
+{
+#if defined(JREVDCT_AVX2)
+  if (cpuext & RETRO_SIMD_AVX2)
+    return j_rev_dct_avx2;
+#endif
+#if defined(JREVDCT_SSE2)
+  return j_rev_dct_sse2;
+#elif defined(JREVDCT_NEON)
+  return j_rev_dct_neon;
+#else
+  return j_rev_dct;
+#endif
+}
@@ -10,8 +10,19 @@ extern "C" {
 typedef int32* DCTBLOCK;     
 typedef int32 DCTELEM;
 
+typedef void (*j_rev_dct_func)(DCTBLOCK data);
+
 void j_rev_dct(DCTBLOCK data);
 
+/* Only data[0] may be nonzero. */
+void j_rev_dct_dc(DCTBLOCK data);
+
+/* Only rows 0-3 (data[0] through data[31]) may be nonzero. */
+void j_rev_dct_sparse(DCTBLOCK data);
+
+/* Returns the fastest available equivalent of j_rev_dct(), cpuext being a RETRO_SIMD_* mask. */
+j_rev_dct_func j_rev_dct_select(uint64 cpuext);
+
 #ifdef __cplusplus
 }
 #endif
@@ -498,6 +498,23 @@ uint8 KING_RB_Fetch(void)
  return(ret);
 }
 
+// Same as "count" calls to KING_RB_Fetch(), but leaves the read position alone; KING_RB_Skip() advances it separately.
+void KING_RB_Peek(uint8 *dest, uint32 count)
+{
+ uint32 pos = king->RAINBOWKRAMReadPos;
+
+ for(uint32 i = 0; i < count; i++)
+ {
+  dest[i] = king->RainbowPagePtr[(pos >> 1) & 0x3FFFF] >> ((pos & 1) * 8);
+  pos = ((pos + 1) & 0x3FFFF) | (pos & 0x40000);
+ }
+}
+
+void KING_RB_Skip(uint32 count)
+{
+ king->RAINBOWKRAMReadPos = ((king->RAINBOWKRAMReadPos + count) & 0x3FFFF) | (king->RAINBOWKRAMReadPos & 0x40000);
+}
+
 static void DoRealDMA(uint8 db)
 {
  if(!king->DMATransferFlipFlop)
@@ -1373,6 +1390,9 @@ void KING_Write16(const v810_timestamp_t timestamp, uint32 A, uint16 V)
 		case 0x50: 
 			   if(!msh)
 			   {
+			    // The sound box runs its ADPCM ticks lazily, so bring it up to date before the enable/rate bits change.
+			    SoundBox_ADPCMUpdate(timestamp);
+
 			    for(int ch = 0; ch < 2; ch++)
 			    {
 			     if(!(king->ADPCMControl & (1 << ch)) && (V & (1 << ch)))
@@ -1383,6 +1403,7 @@ void KING_Write16(const v810_timestamp_t timestamp, uint32 A, uint16 V)
 			    king->ADPCMControl = V; 
 			    RedoKINGIRQCheck();
 			    SoundBox_SetKINGADPCMControl(king->ADPCMControl);
+			    PCFX_SetEvent(PCFX_EVENT_ADPCM, SoundBox_ADPCMUpdate(timestamp));
 			   }
 			   break;
 
@@ -1539,6 +1560,7 @@ void KING_Close(void)
 void KING_Reset(const v810_timestamp_t timestamp)
 {
  KING_Update(timestamp);
+ RAINBOW_Sync();	// Before RAINBOWKRAMReadPos is cleared.
 
  memset(&fx_vce, 0, sizeof(fx_vce));
 
@@ -2800,6 +2822,8 @@ void KING_SetLayerEnableMask(uint64 mask)
 
 int KING_StateAction(StateMem *sm, int load, int data_only)
 {
+ RAINBOW_Sync();	// Settle RAINBOWKRAMReadPos.
+
  SFORMAT KINGStateRegs[] =
  {
   SFVARN(king->AR, "AR"),
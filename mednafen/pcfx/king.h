@@ -20,6 +20,8 @@ uint16 KING_GetADPCMHalfWord(int ch);
 uint8 KING_MemPeek(uint32 A);
 
 uint8 KING_RB_Fetch();
+void KING_RB_Peek(uint8 *dest, uint32 count);
+void KING_RB_Skip(uint32 count);
 
 void KING_SetLayerEnableMask(uint64 mask);
 
@@ -26,6 +26,33 @@
 #include "../clamp.h"
 #include "../state_helpers.h"
 
+#include <libretro.h>
+#include <encodings/crc32.h>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <vector>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(ARCH_X86) && defined(__GNUC__)
+#define RAINBOW_SSSE3
+#include <tmmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define RAINBOW_NEON
+#include <arm_neon.h>
+#endif
+
+extern retro_get_cpu_features_t perf_get_cpu_features_cb;
+
 static bool ChromaIP;	// Bilinearly interpolate chroma channel
 
 /* Y = luminance/luma, UV = chrominance/chroma */
@@ -299,12 +326,16 @@ static uint16 HScroll;
 static uint32 bits_buffer;
 static uint32 bits_buffered_bits;
 static int32 bits_bytes_left;
+static const uint8 *bits_src;
+static uint32 bits_src_pos;	// Raw KRAM bytes consumed, including the byte after each 0xFF.
 
-static void InitBits(int32 bcount)
+static void InitBits(const uint8 *src, int32 bcount)
 {
  bits_bytes_left = bcount;
  bits_buffer = 0;
  bits_buffered_bits = 0;
+ bits_src = src;
+ bits_src_pos = 0;
 }
 
 static INLINE uint8 FetchWidgywabbit(void)
@@ -312,9 +343,9 @@ static INLINE uint8 FetchWidgywabbit(void)
  if(bits_bytes_left <= 0)
   return(0);
 
- uint8 ret = KING_RB_Fetch();
+ uint8 ret = bits_src[bits_src_pos++];
  if(ret == 0xFF) 
-  KING_RB_Fetch();
+  bits_src_pos++;
 
  bits_bytes_left--;
 
@@ -469,12 +500,14 @@ static uint32 get_dc_uv_coeff(void)
 }
 
 
-static void decode(int32 *dct, const uint32 *QuantTable, const int32 dc, const HuffmanQuickLUT *table)
+// Returns the zigzag position(1-63) of the last nonzero AC coefficient, or 0 if there are none.
+static unsigned decode(int32 *dct, const uint32 *QuantTable, const int32 dc, const HuffmanQuickLUT *table)
 {
  int32 coeff;
  int32 zeroes;
  int count;
  int index;
+ unsigned last = 0;
 
  dct[0] = (int16)(QuantTable[0] * dc);
  count = 0;
@@ -505,18 +538,520 @@ static void decode(int32 *dct, const uint32 *QuantTable, const int32 dc, const H
   {
    index = zigzag[count++];
    dct[index] = (int16)(QuantTable[index] * coeff);
+
+   if(dct[index])
+    last = count;
   }
  } while(count < 63);
 
+ return(last);
+}
+
+static j_rev_dct_func IDCT_Full;
+static bool IDCT_UseSparse;
+static bool FetchUseSSSE3;
+
+static INLINE void IDCT(int32 *dct, const unsigned last)
+{
+ if(!last)
+  j_rev_dct_dc(dct);
+ else if(last <= 9 && IDCT_UseSparse)	// Zigzag positions 1-9 are all in rows 0-3.
+  j_rev_dct_sparse(dct);
+ else
+  IDCT_Full(dct);
+}
+
+// Bitmask, per buffer, of YUV lines that have been fetched and so must read back as zeroes.
+static uint32 PendingClear[2];
+
+static void FlushPendingClear(const unsigned which, const unsigned start_byte)
+{
+ for(unsigned line = 0; line < 16; line++)
+ {
+  if(PendingClear[which] & (1U << line))
+  {
+   const unsigned line_start = std::max<unsigned>(start_byte, line * 256 * 4);
+   const unsigned line_end = (line + 1) * 256 * 4;
+
+   if(line_start < line_end)
+    memset(&DecodeBuffer[which][line_start], 0, line_end - line_start);
+  }
+ }
+ PendingClear[which] = 0;
+}
+
+// Number of palette LUT entries needed to cover every index in a palettized buffer.
+static uint32 DecodePaletteSize[2];
+
+static unsigned CalcPaletteSize(const uint8 *buf, const unsigned count)
+{
+ uint8 max_index = 0;
+
+ for(unsigned i = 0; i < count; i++)
+  max_index = std::max<uint8>(max_index, buf[i]);
+
+ return(max_index + 1);
 }
 
 static uint32 LastLine[256];
 static bool FirstDecode;
 static bool GarbageData;
 
-bool RAINBOW_Init(bool arg_ChromaIP)
+// Bilinear chroma interpolation, done as two separate passes over a decoded YUV buffer.  Decoding leaves chroma only in
+// the even pixels of the odd lines; the horizontal pass fills in the odd pixels of the odd lines, and the vertical pass
+// then fills in the even lines from the odd lines above and below them.  Averages round down, per U and V byte.
+#if defined(__SSE2__)
+static INLINE __m128i ChromaAvg(const __m128i a, const __m128i b)
+{
+ return(_mm_add_epi8(_mm_and_si128(a, b), _mm_and_si128(_mm_srli_epi32(_mm_xor_si128(a, b), 1), _mm_set1_epi8(0x7F))));
+}
+#endif
+
+static INLINE uint32 ChromaAvg(const uint32 a, const uint32 b)
+{
+ const unsigned int u = (((a >> 8) & 0xFF) + ((b >> 8) & 0xFF)) >> 1;
+ const unsigned int v = (((a >> 0) & 0xFF) + ((b >> 0) & 0xFF)) >> 1;
+
+ return((u << 8) | v);
+}
+
+static void ChromaInterpolateH(uint32 *line)
+{
+ int x = 0;
+
+ // Each vector covers two even/odd pixel pairs; averaging it with the same vector two pixels on gives the odd pixels'
+ // chroma in the even lanes.
+#if defined(__SSE2__)
+ const __m128i odd_uv = _mm_set_epi32(0xFFFF, 0, 0xFFFF, 0);
+
+ for(; x < 252; x += 4)
+ {
+  const __m128i a = _mm_loadu_si128((const __m128i *)&line[x]);
+  const __m128i avg = _mm_slli_si128(ChromaAvg(a, _mm_loadu_si128((const __m128i *)&line[x + 2])), 4);
+
+  _mm_storeu_si128((__m128i *)&line[x], _mm_or_si128(_mm_andnot_si128(odd_uv, a), _mm_and_si128(odd_uv, avg)));
+ }
+#elif defined(RAINBOW_NEON)
+ static const uint32 odd_uv_tab[4] = { 0, 0xFFFF, 0, 0xFFFF };
+ const uint32x4_t odd_uv = vld1q_u32(odd_uv_tab);
+
+ for(; x < 252; x += 4)
+ {
+  const uint32x4_t a = vld1q_u32(&line[x]);
+  const uint8x16_t avg = vhaddq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(vld1q_u32(&line[x + 2])));
+
+  vst1q_u32(&line[x], vbslq_u32(odd_uv, vextq_u32(vdupq_n_u32(0), vreinterpretq_u32_u8(avg), 3), a));
+ }
+#endif
+
+ for(; x < 254; x += 2)
+  line[x + 1] = (line[x + 1] & ~ 0xFFFF) | ChromaAvg(line[x], line[x + 2]);
+
+ line[0xFF] = (line[0xFF] & ~ 0xFFFF) | (line[0xFE] & 0xFFFF);
+}
+
+static void ChromaInterpolateV(uint32 *line, const uint32 *above, const uint32 *below)
+{
+ int x = 0;
+
+#if defined(__SSE2__)
+ const __m128i uv = _mm_set1_epi32(0xFFFF);
+
+ for(; x < 256; x += 4)
+ {
+  const __m128i l = _mm_loadu_si128((const __m128i *)&line[x]);
+  const __m128i avg = ChromaAvg(_mm_loadu_si128((const __m128i *)&above[x]), _mm_loadu_si128((const __m128i *)&below[x]));
+
+  _mm_storeu_si128((__m128i *)&line[x], _mm_or_si128(_mm_andnot_si128(uv, l), _mm_and_si128(uv, avg)));
+ }
+#elif defined(RAINBOW_NEON)
+ const uint32x4_t uv = vdupq_n_u32(0xFFFF);
+
+ for(; x < 256; x += 4)
+ {
+  const uint8x16_t avg = vhaddq_u8(vld1q_u8((const uint8 *)&above[x]), vld1q_u8((const uint8 *)&below[x]));
+
+  vst1q_u32(&line[x], vbslq_u32(uv, vreinterpretq_u32_u8(avg), vld1q_u32(&line[x])));
+ }
+#endif
+
+ for(; x < 256; x++)
+  line[x] = (line[x] & ~ 0xFFFF) | ChromaAvg(above[x], below[x]);
+}
+
+static void ChromaInterpolate(uint32 *dest_base)
+{
+ for(int y = 1; y < 16; y += 2)
+  ChromaInterpolateH(&dest_base[y * 256]);
+
+ for(int y = 0; y < 16; y += 2)
+ {
+  const uint32 *below = &dest_base[(y + 1) * 256];
+  const uint32 *above;
+
+  if(y)
+   above = &dest_base[(y - 1) * 256];
+  else if(FirstDecode)
+   above = below;
+  else
+   above = LastLine;
+
+  ChromaInterpolateV(&dest_base[y * 256], above, below);
+ }
+
+ FirstDecode = FALSE;
+ memcpy(LastLine, &dest_base[15 * 256], sizeof(LastLine));
+}
+
+// A YUV block, with everything it needs from the emulation thread captured up front so that it can be decoded on
+// the decode thread; see RAINBOW_DecodeBlock() and RAINBOW_Sync().
+struct YUVJob
+{
+ unsigned which;	// Buffer to decode into
+ int32 block_size;
+ bool skip;
+ uint32 happy_color;
+
+ uint32 consumed;	// Output; KRAM bytes to advance the read position by once done.
+};
+
+static uint8 *BlockData = NULL;	// Raw block data, copied out of KRAM.
+static YUVJob Job;
+static bool JobOutstanding;	// Job's KRAM read position advance hasn't been applied yet.
+
+// Cache of decoded YUV blocks, for FMV that loops or repeats.  An entry is keyed by the block data together with all
+// of the decoder state that the decode depends on, and holds the decoded buffer and the decoder state afterwards.
+struct CacheEntry
+{
+ uint32 hash;
+ std::vector<uint8> key;
+
+ uint32 pixels[0x2000];
+ uint32 quant[2][64];
+ uint32 consumed;
+};
+
+static uint32 CacheBudget;	// In bytes, 0 = disabled
+static uint32 CacheUsed;
+static std::list<CacheEntry*> CacheLRU;	// Most recently used at the front.
+static std::map<uint32, std::list<CacheEntry*>::iterator> CacheIndex;
+static std::vector<uint8> CacheKey;
+static uint32 CacheKeyHash;
+static uint64 CacheHits, CacheMisses;
+
+static INLINE uint32 CacheEntryCost(const CacheEntry *ce)
+{
+ return(sizeof(CacheEntry) + ce->key.size());
+}
+
+static void CacheEvict(std::list<CacheEntry*>::iterator it)
+{
+ CacheEntry *ce = *it;
+
+ CacheUsed -= CacheEntryCost(ce);
+ CacheIndex.erase(ce->hash);
+ CacheLRU.erase(it);
+ delete ce;
+}
+
+static void CacheClear(void)
+{
+ while(!CacheLRU.empty())
+  CacheEvict(CacheLRU.begin());
+}
+
+static void CacheAppendKey(const void *data, size_t len)
+{
+ CacheKey.insert(CacheKey.end(), (const uint8 *)data, (const uint8 *)data + len);
+}
+
+static void CacheMakeKey(const YUVJob *job)
+{
+ uint32 raw_len = 0;
+
+ // Cover all of the data the decoder could possibly read, not just what it ends up reading.
+ for(int32 n = job->block_size; n > 0; n--)
+  raw_len += (BlockData[raw_len] == 0xFF) ? 2 : 1;
+
+ CacheKey.clear();
+ CacheAppendKey(BlockData, raw_len);
+ CacheAppendKey(QuantTables, sizeof(QuantTables));
+ CacheAppendKey(QuantTablesBase, sizeof(QuantTablesBase));
+ CacheAppendKey(&job->happy_color, sizeof(job->happy_color));
+ CacheAppendKey(&ChromaIP, sizeof(ChromaIP));
+
+ if(ChromaIP)
+ {
+  CacheAppendKey(&FirstDecode, sizeof(FirstDecode));
+  if(!FirstDecode)
+   CacheAppendKey(LastLine, sizeof(LastLine));
+ }
+
+ CacheKeyHash = encoding_crc32(0, &CacheKey[0], CacheKey.size());
+}
+
+static bool CacheLookup(YUVJob *job)
+{
+ std::map<uint32, std::list<CacheEntry*>::iterator>::iterator mit = CacheIndex.find(CacheKeyHash);
+
+ if(mit == CacheIndex.end() || (*mit->second)->key != CacheKey)
+ {
+  CacheMisses++;
+  return(false);
+ }
+
+ CacheEntry *ce = *mit->second;
+
+ CacheLRU.splice(CacheLRU.begin(), CacheLRU, mit->second);
+ CacheHits++;
+
+ memcpy(DecodeBuffer[job->which], ce->pixels, sizeof(ce->pixels));
+ PendingClear[job->which] = 0;
+
+ if(ChromaIP)
+ {
+  memcpy(LastLine, &ce->pixels[15 * 256], sizeof(LastLine));
+  FirstDecode = FALSE;
+ }
+
+ memcpy(QuantTables, ce->quant, sizeof(QuantTables));
+ job->consumed = ce->consumed;
+
+ return(true);
+}
+
+static void CacheInsert(const YUVJob *job)
+{
+ std::map<uint32, std::list<CacheEntry*>::iterator>::iterator mit = CacheIndex.find(CacheKeyHash);
+
+ if(mit != CacheIndex.end())
+  CacheEvict(mit->second);
+
+ CacheEntry *ce = new CacheEntry;
+
+ ce->hash = CacheKeyHash;
+ ce->key = CacheKey;
+ memcpy(ce->pixels, DecodeBuffer[job->which], sizeof(ce->pixels));
+ memcpy(ce->quant, QuantTables, sizeof(QuantTables));
+ ce->consumed = job->consumed;
+
+ if(CacheEntryCost(ce) > CacheBudget)
+ {
+  delete ce;
+  return;
+ }
+
+ while(CacheUsed + CacheEntryCost(ce) > CacheBudget)
+  CacheEvict(--CacheLRU.end());
+
+ CacheLRU.push_front(ce);
+ CacheIndex[ce->hash] = CacheLRU.begin();
+ CacheUsed += CacheEntryCost(ce);
+}
+
+// Besides the job's own buffer, this touches QuantTables, LastLine, and FirstDecode, which are therefore
+// off-limits to the emulation thread while a job is outstanding.
+static void DecodeYUVBlock(YUVJob *job)
+{
+ // A skipped decode still writes null runs into the buffer, so skipped decodes bypass the cache altogether.
+ if(CacheBudget && !job->skip)
+ {
+  CacheMakeKey(job);
+  if(CacheLookup(job))
+   return;
+ }
+
+ InitBits(BlockData, job->block_size);
+
+ // Every pixel of the buffer is rewritten below unless decoding is being skipped.
+ if(job->skip)
+  FlushPendingClear(job->which, 0);
+ else
+  PendingClear[job->which] = 0;
+
+ int32 dc_y = 0, dc_u = 0, dc_v = 0;
+ uint32 *dest_base = (uint32 *)DecodeBuffer[job->which];
+ for(int column = 0; column < 16; column++)
+ {
+  uint32 *dest_base_column = &dest_base[column * 16];
+  int32 zeroes = 0;
+
+  dc_y += get_dc_y_coeff(&zeroes);
+
+  if(zeroes) // If set, clear the number of columns
+  {
+   do
+   {
+    if(column < 16)
+    {
+     dest_base_column = &dest_base[column * 16];
+
+     for(int y = 0; y < 16; y++)
+      for(int x = 0; x < 16; x++)
+       dest_base_column[y * 256 + x] = job->happy_color;
+    }
+    column++;
+    zeroes--;
+   } while(zeroes);
+   column--; // Fix for the column autoincrement in the while(zeroes) loop
+   dc_y = dc_u = dc_v = 0;
+  }
+  else
+  {
+   int32 dct_y[256];
+   int32 dct_u[64];
+   int32 dct_v[64];
+   unsigned last[6];
+
+   // Y/Luma, 16x16 components
+   // ---------
+   // | A | C |
+   // |-------|
+   // | B | D |
+   // ---------
+   // A (0, 0)
+   last[0] = decode(&dct_y[0x00], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // B (0, 1)
+   dc_y += get_dc_y_coeff(&zeroes);
+   last[1] = decode(&dct_y[0x40], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // C (1, 0)
+   dc_y += get_dc_y_coeff(&zeroes);
+   last[2] = decode(&dct_y[0x80], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // D (1, 1)
+   dc_y += get_dc_y_coeff(&zeroes);
+   last[3] = decode(&dct_y[0xC0], QuantTables[0], dc_y, &ac_y_qlut);
+
+   // U, 8x8 components
+   dc_u += get_dc_uv_coeff();
+   last[4] = decode(&dct_u[0x00], QuantTables[1], dc_u, &ac_uv_qlut);
+
+   // V, 8x8 components
+   dc_v += get_dc_uv_coeff();
+   last[5] = decode(&dct_v[0x00], QuantTables[1], dc_v, &ac_uv_qlut);
+
+   if(job->skip)
+    continue;
+
+   IDCT(&dct_y[0x00], last[0]);
+   IDCT(&dct_y[0x40], last[1]);
+   IDCT(&dct_y[0x80], last[2]);
+   IDCT(&dct_y[0xC0], last[3]);
+   IDCT(&dct_u[0x00], last[4]);
+   IDCT(&dct_v[0x00], last[5]);
+
+   for(int y = 0; y < 16; y++)
+    for(int x = 0; x < 16; x++)
+     dest_base_column[y * 256 + x] = clamp_to_u8(dct_y[y * 8 + (x & 0x7) + ((x & 0x8) << 4)] + 0x80) << 16;
+
+   if(!ChromaIP)
+   {
+    for(int y = 0; y < 8; y++)
+    {
+     for(int x = 0; x < 8; x++)
+     {
+      uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
+      dest_base_column[y * 512 + (256 * 0) + x * 2 + 0] |= component_uv;
+      dest_base_column[y * 512 + (256 * 0) + x * 2 + 1] |= component_uv;
+      dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
+      dest_base_column[y * 512 + (256 * 1) + x * 2 + 1] |= component_uv;
+     }
+    }
+   }
+   else
+   {
+    for(int y = 0; y < 8; y++)
+    {
+     for(int x = 0; x < 8; x++)
+     {
+      uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
+      dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
+     }
+    }
+   }
+  }
+ }
+
+ // Do bilinear interpolation on the chroma channels:
+ if(!job->skip && ChromaIP)
+  ChromaInterpolate(dest_base);
+
+ job->consumed = bits_src_pos;
+
+ if(CacheBudget && !job->skip)
+  CacheInsert(job);
+}
+
+#ifdef HAVE_THREADS
+static sthread_t *DecodeThread = NULL;
+static slock_t *DecodeMutex = NULL;
+static scond_t *DecodeCond = NULL;
+static bool JobPending;		// Protected by DecodeMutex
+static bool DecodeThreadExit;	// Protected by DecodeMutex
+
+static void DecodeThreadMain(void *arg)
+{
+ slock_lock(DecodeMutex);
+
+ for(;;)
+ {
+  while(!JobPending && !DecodeThreadExit)
+   scond_wait(DecodeCond, DecodeMutex);
+
+  if(DecodeThreadExit)
+   break;
+
+  slock_unlock(DecodeMutex);
+  DecodeYUVBlock(&Job);
+  slock_lock(DecodeMutex);
+
+  JobPending = FALSE;
+  scond_signal(DecodeCond);
+ }
+
+ slock_unlock(DecodeMutex);
+}
+#endif
+
+// Waits for any outstanding block decode, and advances the KRAM read position past the data it used.  KING calls this
+// before it resets or saves/loads RAINBOWKRAMReadPos.
+void RAINBOW_Sync(void)
+{
+ if(!JobOutstanding)
+  return;
+
+#ifdef HAVE_THREADS
+ if(DecodeThread)
+ {
+  slock_lock(DecodeMutex);
+  while(JobPending)
+   scond_wait(DecodeCond, DecodeMutex);
+  slock_unlock(DecodeMutex);
+ }
+#endif
+
+ KING_RB_Skip(Job.consumed);
+ JobOutstanding = FALSE;
+}
+
+
+bool RAINBOW_Init(bool arg_ChromaIP, bool arg_Threaded, uint32 arg_CacheSize)
 {
  ChromaIP = arg_ChromaIP;
+ CacheBudget = arg_CacheSize;
+ CacheUsed = 0;
+ CacheHits = CacheMisses = 0;
+
+ // The SIMD transforms beat the scalar sparse shortcut, so only use it when falling back to scalar.
+ {
+  const uint64 cpuext = perf_get_cpu_features_cb ? perf_get_cpu_features_cb() : 0;
+
+  IDCT_Full = j_rev_dct_select(cpuext);
+  IDCT_UseSparse = (IDCT_Full == j_rev_dct);
+  FetchUseSSSE3 = (cpuext & RETRO_SIMD_SSSE3) != 0;
+ }
 
  for(int i = 0; i < 2; i++)
  {
@@ -525,6 +1060,9 @@ bool RAINBOW_Init(bool arg_ChromaIP)
   memset(DecodeBuffer[i], 0, 0x2000 * 4);
  }
 
+ if(!(BlockData = (uint8*)malloc(0x10000)))
+  return(0);
+
  if(!BuildHuffmanLUT(&dc_y_table, &dc_y_qlut, 9))
   return(FALSE);
 
@@ -538,16 +1076,65 @@ bool RAINBOW_Init(bool arg_ChromaIP)
   return(FALSE);
 
  DecodeFormat[0] = DecodeFormat[1] = -1;
+ DecodePaletteSize[0] = DecodePaletteSize[1] = 1;
+ PendingClear[0] = PendingClear[1] = 0;
  DecodeBufferWhichRead = 0;
  GarbageData = FALSE;
  FirstDecode = TRUE;
  RasterReadPos = 0;
+ JobOutstanding = FALSE;
+
+#ifdef HAVE_THREADS
+ if(arg_Threaded)
+ {
+  DecodeMutex = slock_new();
+  DecodeCond = scond_new();
+  JobPending = FALSE;
+  DecodeThreadExit = FALSE;
+  DecodeThread = sthread_create(DecodeThreadMain, NULL);
+ }
+#endif
 
  return(1);
 }
 
 void RAINBOW_Close(void)
 {
+ RAINBOW_Sync();
+
+#ifdef HAVE_THREADS
+ if(DecodeThread)
+ {
+  slock_lock(DecodeMutex);
+  DecodeThreadExit = TRUE;
+  scond_signal(DecodeCond);
+  slock_unlock(DecodeMutex);
+
+  sthread_join(DecodeThread);
+  DecodeThread = NULL;
+ }
+
+ if(DecodeCond)
+ {
+  scond_free(DecodeCond);
+  DecodeCond = NULL;
+ }
+
+ if(DecodeMutex)
+ {
+  slock_free(DecodeMutex);
+  DecodeMutex = NULL;
+ }
+#endif
+
+ if(BlockData)
+ {
+  free(BlockData);
+  BlockData = NULL;
+ }
+
+ CacheClear();
+
  for(int i = 0; i < 2; i++)
   if(DecodeBuffer[i])
   {
@@ -596,6 +1183,14 @@ void RAINBOW_Write16(uint32 A, uint16 V)
  }
 }
 
+void RAINBOW_GetCacheStats(uint64 *hits, uint64 *misses)
+{
+ RAINBOW_Sync();
+
+ *hits = CacheHits;
+ *misses = CacheMisses;
+}
+
 void RAINBOW_ForceTransferReset(void)
 {
  RasterReadPos = 0;
@@ -604,6 +1199,8 @@ void RAINBOW_ForceTransferReset(void)
 
 void RAINBOW_SwapBuffers(void)
 {
+ RAINBOW_Sync();
+
  DecodeBufferWhichRead ^= 1;
  RasterReadPos = 0;
 }
@@ -615,6 +1212,8 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
    int icount;
    int which_buffer = DecodeBufferWhichRead ^ 1;
 
+   RAINBOW_Sync();
+
    if(!(Control & 0x01))
     return;
 
@@ -659,6 +1258,8 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
     GarbageData = TRUE;
     DecodeFormat[which_buffer] = 0;
     memset(DecodeBuffer[which_buffer], 0, 0x2000);
+    FlushPendingClear(which_buffer, 0x2000);
+    DecodePaletteSize[which_buffer] = 1;
     goto BufferNoDecode;
    }
 
@@ -682,151 +1283,30 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
      block_size -= 128;
     }
 
-    InitBits(block_size);
-
-    int32 dc_y = 0, dc_u = 0, dc_v = 0;
-    uint32 *dest_base = (uint32 *)DecodeBuffer[which_buffer];
-    for(int column = 0; column < 16; column++)
-    {
-     uint32 *dest_base_column = &dest_base[column * 16];
-     int32 zeroes = 0;
+    // The worst case is every byte being 0xFF and so followed by a byte that is thrown away.
+    KING_RB_Peek(BlockData, std::max<int32>(block_size, 0) * 2);
 
-     dc_y += get_dc_y_coeff(&zeroes);
+    Job.which = which_buffer;
+    Job.block_size = block_size;
+    Job.skip = Skip;
+    Job.happy_color = HappyColor;
+    Job.consumed = 0;
+    JobOutstanding = TRUE;
 
-     if(zeroes) // If set, clear the number of columns
-     {
-      do
-      {
-       if(column < 16)
-       {
-	dest_base_column = &dest_base[column * 16];
-
-        for(int y = 0; y < 16; y++)
-         for(int x = 0; x < 16; x++)
-          dest_base_column[y * 256 + x] = HappyColor;
-       }
-       column++;
-       zeroes--;
-      } while(zeroes);
-      column--; // Fix for the column autoincrement in the while(zeroes) loop
-      dc_y = dc_u = dc_v = 0;
-     }
-     else
-     {
-      int32 dct_y[256];
-      int32 dct_u[64];
-      int32 dct_v[64];
-
-      // Y/Luma, 16x16 components
-      // ---------
-      // | A | C |
-      // |-------|
-      // | B | D |
-      // ---------
-      // A (0, 0)
-      decode(&dct_y[0x00], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // B (0, 1)
-      dc_y += get_dc_y_coeff(&zeroes);
-      decode(&dct_y[0x40], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // C (1, 0)
-      dc_y += get_dc_y_coeff(&zeroes);
-      decode(&dct_y[0x80], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // D (1, 1)
-      dc_y += get_dc_y_coeff(&zeroes);
-      decode(&dct_y[0xC0], QuantTables[0], dc_y, &ac_y_qlut);
-
-      // U, 8x8 components
-      dc_u += get_dc_uv_coeff();
-      decode(&dct_u[0x00], QuantTables[1], dc_u, &ac_uv_qlut);
-
-      // V, 8x8 components
-      dc_v += get_dc_uv_coeff();
-      decode(&dct_v[0x00], QuantTables[1], dc_v, &ac_uv_qlut);
-
-      if(Skip)
-       continue;
-
-      j_rev_dct(&dct_y[0x00]);
-      j_rev_dct(&dct_y[0x40]);
-      j_rev_dct(&dct_y[0x80]);
-      j_rev_dct(&dct_y[0xC0]);
-      j_rev_dct(&dct_u[0x00]);
-      j_rev_dct(&dct_v[0x00]);
-
-      for(int y = 0; y < 16; y++)
-       for(int x = 0; x < 16; x++)
-        dest_base_column[y * 256 + x] = clamp_to_u8(dct_y[y * 8 + (x & 0x7) + ((x & 0x8) << 4)] + 0x80) << 16;
-
-      if(!ChromaIP)
-      {
-       for(int y = 0; y < 8; y++)
-       {
-        for(int x = 0; x < 8; x++)
-        {
-         uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
-         dest_base_column[y * 512 + (256 * 0) + x * 2 + 0] |= component_uv;
-         dest_base_column[y * 512 + (256 * 0) + x * 2 + 1] |= component_uv;
-         dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
-         dest_base_column[y * 512 + (256 * 1) + x * 2 + 1] |= component_uv;
-        }
-       }
-      }
-      else
-      {
-       for(int y = 0; y < 8; y++)
-       {
-        for(int x = 0; x < 8; x++)
-        {
-         uint32 component_uv = (clamp_to_u8(dct_u[y * 8 + x] + 0x80) << 8) | clamp_to_u8(dct_v[y * 8 + x] + 0x80);
- 	 dest_base_column[y * 512 + (256 * 1) + x * 2 + 0] |= component_uv;
-        }
-       }
-      }
-     }
+#ifdef HAVE_THREADS
+    if(DecodeThread)
+    {
+     slock_lock(DecodeMutex);
+     JobPending = TRUE;
+     scond_signal(DecodeCond);
+     slock_unlock(DecodeMutex);
     }
-
-    // Do bilinear interpolation on the chroma channels:
-    if(!Skip && ChromaIP)
+    else
+#endif
     {
-     for(int y = 0; y < 16; y+= 2)
-     {
-      uint32 *linebase = &dest_base[y * 256];
-      uint32 *linebase1 = &dest_base[(y + 1) * 256];
-
-      for(int x = 0; x < 254; x += 2)
-      {
-       unsigned int u, v;
-
-       u = (((linebase1[x] >> 8) & 0xFF) + ((linebase1[x + 2] >> 8) & 0xFF)) >> 1;
-       v = (((linebase1[x] >> 0) & 0xFF) + ((linebase1[x + 2] >> 0) & 0xFF)) >> 1;
-
-       linebase1[x + 1] = (linebase1[x + 1] & ~ 0xFFFF) | (u << 8) | v;
-      }
-
-      linebase1[0xFF] = (linebase1[0xFF] & ~ 0xFFFF) | (linebase1[0xFE] & 0xFFFF);
-
-      if(FirstDecode)
-      {
-       for(int x = 0; x < 256; x++) linebase[x] = (linebase[x] & ~ 0xFFFF) | (linebase1[x] & 0xFFFF);
-       FirstDecode = 0;
-      }
-      else
-       for(int x = 0; x < 256; x++)
-       {
-        unsigned int u, v;
- 
-        u = (((LastLine[x] >> 8) & 0xFF) + ((linebase1[x] >> 8) & 0xFF)) >> 1;
-        v = (((LastLine[x] >> 0) & 0xFF) + ((linebase1[x] >> 0) & 0xFF)) >> 1;
-
-        linebase[x] = (linebase[x] & ~ 0xFFFF) | (u << 8) | v;
-       }
-
-      memcpy(LastLine, linebase1, 256 * 4);
-     }
-    } // End chroma interpolation
+     DecodeYUVBlock(&Job);
+     RAINBOW_Sync();
+    }
    } // end jpeg-like decoding
    else 
    {
@@ -872,6 +1352,11 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
       x++;
      }
     }
+
+    // A short block leaves older data in the rest of the buffer, which RAINBOW_FetchRaster() needs
+    // to be able to index its palette LUT with.
+    FlushPendingClear(which_buffer, x);
+    DecodePaletteSize[which_buffer] = std::max<unsigned>(1U << (8 - plt_shift), CalcPaletteSize(&DecodeBuffer[which_buffer][x], 0x2000 - x));
    } // end RLE decoding
 
    //for(int i = 0; i < 8 + block_size; i++)
@@ -882,6 +1367,124 @@ void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip)
 
 void KING_Moo(void);
 
+// Span helpers for RAINBOW_FetchRaster().  The scroll wraparound is resolved into at most two contiguous
+// source spans per line by the caller, so these only deal with straight runs of pixels.
+static INLINE void RasterZeroSpan(uint32 *out, unsigned count)
+{
+ memset(out, 0, count * sizeof(uint32));
+}
+
+static INLINE void RasterYUVSpan(uint32 *out, const uint32 *in, unsigned count, const uint32 layer_or)
+{
+#if defined(__SSE2__)
+ const __m128i o = _mm_set1_epi32(layer_or);
+
+ for(; count >= 4; count -= 4, in += 4, out += 4)
+  _mm_storeu_si128((__m128i *)out, _mm_or_si128(_mm_loadu_si128((const __m128i *)in), o));
+#elif defined(RAINBOW_NEON)
+ const uint32x4_t o = vdupq_n_u32(layer_or);
+
+ for(; count >= 4; count -= 4, in += 4, out += 4)
+  vst1q_u32(out, vorrq_u32(vld1q_u32(in), o));
+#endif
+
+ for(; count; count--)
+  *out++ = *in++ | layer_or;
+}
+
+#if defined(RAINBOW_SSSE3)
+// 16-color lines: look up 16 pixels at a time with one byte shuffle per byte of the palette entries.
+static __attribute__((target("ssse3"))) void RasterPaletteSpan16_SSSE3(uint32 *out, const uint8 *in, unsigned count, const uint32 *lut)
+{
+ __m128i planes[4];
+
+ for(unsigned b = 0; b < 4; b++)
+ {
+  uint8 tmp[16];
+
+  for(unsigned i = 0; i < 16; i++)
+   tmp[i] = lut[i] >> (b * 8);
+
+  planes[b] = _mm_loadu_si128((const __m128i *)tmp);
+ }
+
+ for(; count >= 16; count -= 16, in += 16, out += 16)
+ {
+  const __m128i idx = _mm_loadu_si128((const __m128i *)in);
+  const __m128i b0 = _mm_shuffle_epi8(planes[0], idx);
+  const __m128i b1 = _mm_shuffle_epi8(planes[1], idx);
+  const __m128i b2 = _mm_shuffle_epi8(planes[2], idx);
+  const __m128i b3 = _mm_shuffle_epi8(planes[3], idx);
+  const __m128i lo01 = _mm_unpacklo_epi8(b0, b1);
+  const __m128i hi01 = _mm_unpackhi_epi8(b0, b1);
+  const __m128i lo23 = _mm_unpacklo_epi8(b2, b3);
+  const __m128i hi23 = _mm_unpackhi_epi8(b2, b3);
+
+  _mm_storeu_si128((__m128i *)&out[0x0], _mm_unpacklo_epi16(lo01, lo23));
+  _mm_storeu_si128((__m128i *)&out[0x4], _mm_unpackhi_epi16(lo01, lo23));
+  _mm_storeu_si128((__m128i *)&out[0x8], _mm_unpacklo_epi16(hi01, hi23));
+  _mm_storeu_si128((__m128i *)&out[0xC], _mm_unpackhi_epi16(hi01, hi23));
+ }
+
+ for(; count; count--)
+  *out++ = lut[*in++];
+}
+#endif
+
+#if defined(RAINBOW_NEON) && defined(__aarch64__)
+static void RasterPaletteSpan16_NEON(uint32 *out, const uint8 *in, unsigned count, const uint32 *lut)
+{
+ uint8x16_t planes[4];
+
+ for(unsigned b = 0; b < 4; b++)
+ {
+  uint8 tmp[16];
+
+  for(unsigned i = 0; i < 16; i++)
+   tmp[i] = lut[i] >> (b * 8);
+
+  planes[b] = vld1q_u8(tmp);
+ }
+
+ for(; count >= 16; count -= 16, in += 16, out += 16)
+ {
+  const uint8x16_t idx = vld1q_u8(in);
+  uint8x16x4_t px;
+
+  px.val[0] = vqtbl1q_u8(planes[0], idx);
+  px.val[1] = vqtbl1q_u8(planes[1], idx);
+  px.val[2] = vqtbl1q_u8(planes[2], idx);
+  px.val[3] = vqtbl1q_u8(planes[3], idx);
+
+  vst4q_u8((uint8 *)out, px);
+ }
+
+ for(; count; count--)
+  *out++ = lut[*in++];
+}
+#endif
+
+// lut[] has the layer bits ORed in, and entry 0(transparent) forced to 0.
+static INLINE void RasterPaletteSpan(uint32 *out, const uint8 *in, unsigned count, const uint32 *lut, const unsigned lut_size)
+{
+ if(lut_size <= 16)
+ {
+#if defined(RAINBOW_SSSE3)
+  if(FetchUseSSSE3)
+  {
+   RasterPaletteSpan16_SSSE3(out, in, count, lut);
+   return;
+  }
+#elif defined(RAINBOW_NEON) && defined(__aarch64__)
+  RasterPaletteSpan16_NEON(out, in, count, lut);
+  return;
+#endif
+ }
+
+ for(; count; count--)
+  *out++ = lut[*in++];
+}
+
 // NOTE:  layer_or and palette_ptr are optimizations, the real RAINBOW chip knows not of such things.
 int RAINBOW_FetchRaster(uint32 *linebuffer, uint32 layer_or, uint32 *palette_ptr)
 {
@@ -902,51 +1505,63 @@ int RAINBOW_FetchRaster(uint32 *linebuffer, uint32 layer_or, uint32 *palette_ptr
 
    if(Control & 0x2)	// Endless scroll mode:
    {
-    uint8 tmpss = HScroll;
+    const unsigned s = HScroll & 0xFF;
 
-    for(int x = 0; x < 256; x++)
-    {
-     linebuffer[x] = in_ptr[tmpss] | layer_or;
-     tmpss++;
-    }
+    RasterYUVSpan(linebuffer, in_ptr + s, 256 - s, layer_or);
+    RasterYUVSpan(linebuffer + 256 - s, in_ptr, s, layer_or);
    }
    else // Non-endless
    {
-    uint16 tmpss = HScroll & 0x1FF;
+    const unsigned s = HScroll & 0x1FF;
 
-    for(int x = 0; x < 256; x++)
+    if(s < 256)
     {
-     linebuffer[x] = (tmpss < 256) ? (in_ptr[tmpss] | layer_or) : 0;
-     tmpss = (tmpss + 1) & 0x1FF;
+     RasterYUVSpan(linebuffer, in_ptr + s, 256 - s, layer_or);
+     RasterZeroSpan(linebuffer + 256 - s, s);
+    }
+    else
+    {
+     RasterZeroSpan(linebuffer, 512 - s);
+     RasterYUVSpan(linebuffer + 512 - s, in_ptr, s - 256, layer_or);
     }
    }
-    MDFN_FastU32MemsetM8(in_ptr, 0, 256);
+
+   // The line reads back as zeroes from now on; the clear itself is deferred(see FlushPendingClear()),
+   // since a following YUV decode will overwrite the whole buffer anyway.
+   PendingClear[DecodeBufferWhichRead] |= 1U << RasterReadPos;
   }
   else if(DecodeFormat[DecodeBufferWhichRead] == 0)	// Palette
   {
    uint8 *in_ptr = &DecodeBuffer[DecodeBufferWhichRead][RasterReadPos * 256];
+   const unsigned lut_size = DecodePaletteSize[DecodeBufferWhichRead];
+   uint32 lut[256];
+
+   lut[0] = 0;
+   for(unsigned i = 1; i < lut_size; i++)
+    lut[i] = palette_ptr[i] | layer_or;
 
    if(Control & 0x2)    // Endless scroll mode:
    {
-    uint8 tmpss = HScroll;
+    const unsigned s = HScroll & 0xFF;
 
-    for(int x = 0; x < 256; x++)
-    {
-     linebuffer[x] = in_ptr[tmpss] ? (palette_ptr[in_ptr[tmpss]] | layer_or) : 0;
-     tmpss++;
-    }
+    RasterPaletteSpan(linebuffer, in_ptr + s, 256 - s, lut, lut_size);
+    RasterPaletteSpan(linebuffer + 256 - s, in_ptr, s, lut, lut_size);
    }
    else // Non-endless
    {
-    uint16 tmpss = HScroll & 0x1FF;
+    const unsigned s = HScroll & 0x1FF;
 
-    for(int x = 0; x < 256; x++)
+    if(s < 256)
     {
-     linebuffer[x] = (tmpss < 256 && in_ptr[tmpss]) ? (palette_ptr[in_ptr[tmpss]] | layer_or) : 0;
-     tmpss = (tmpss + 1) & 0x1FF;
+     RasterPaletteSpan(linebuffer, in_ptr + s, 256 - s, lut, lut_size);
+     RasterZeroSpan(linebuffer + 256 - s, s);
+    }
+    else
+    {
+     RasterZeroSpan(linebuffer, 512 - s);
+     RasterPaletteSpan(linebuffer + 512 - s, in_ptr, s - 256, lut, lut_size);
     }
    }
-   //MDFN_FastU32MemsetM8((uint32 *)in_ptr, 0, 256 / 4);
   }
  }
 
@@ -960,6 +1575,8 @@ int RAINBOW_FetchRaster(uint32 *linebuffer, uint32 layer_or, uint32 *palette_ptr
 
 void RAINBOW_Reset(void)
 {
+ RAINBOW_Sync();
+
  Control = 0;
  NullRunY = NullRunU = NullRunV = 0;
  HScroll = 0;
@@ -976,6 +1593,14 @@ void RAINBOW_Reset(void)
 
 int RAINBOW_StateAction(StateMem *sm, int load, int data_only)
 {
+ RAINBOW_Sync();
+
+ if(!load)
+ {
+  FlushPendingClear(0, 0);
+  FlushPendingClear(1, 0);
+ }
+
  SFORMAT StateRegs[] =
  {
    SFVAR(HScroll),
@@ -999,6 +1624,12 @@ int RAINBOW_StateAction(StateMem *sm, int load, int data_only)
   RasterReadPos &= 0xF;
   DecodeBufferWhichRead &= 0x1;
 
+  for(unsigned i = 0; i < 2; i++)
+  {
+   PendingClear[i] = 0;
+   DecodePaletteSize[i] = CalcPaletteSize(DecodeBuffer[i], 0x2000);
+  }
+
   CalcHappyColor();
  }
  return(ret);
@@ -7,12 +7,14 @@ void RAINBOW_Write16(uint32 A, uint16 V);
 void RAINBOW_ForceTransferReset(void);
 void RAINBOW_SwapBuffers(void);
 void RAINBOW_DecodeBlock(bool arg_FirstDecode, bool Skip);
+void RAINBOW_Sync(void);
 
 int RAINBOW_FetchRaster(uint32 *, uint32 layer_or, uint32 *palette_ptr);
 int RAINBOW_StateAction(StateMem *sm, int load, int data_only);
 
-bool RAINBOW_Init(bool arg_ChromaIP);
+bool RAINBOW_Init(bool arg_ChromaIP, bool arg_Threaded, uint32 arg_CacheSize);
 void RAINBOW_Close(void);
 void RAINBOW_Reset(void);
+void RAINBOW_GetCacheStats(uint64 *hits, uint64 *misses);
 
 #endif
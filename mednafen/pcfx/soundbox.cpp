@@ -253,10 +253,10 @@ void SoundBox_SetKINGADPCMControl(uint32 value)
 
 /* Digital filter designed by mkfilter/mkshape/gencode   A.J. Fisher
    Command line: /www/usr/fisher/helpers/mkfilter -Bu -Lp -o 1 -a 1.5888889125e-04 0.0000000000e+00 -l */
-static void DoVolumeFilter(int ch, int lr)
+static INLINE void DoVolumeFilter(int ch, int lr, double in)
 {
    sbox.vf_xv[ch][lr][0] = sbox.vf_xv[ch][lr][1]; 
-   sbox.vf_xv[ch][lr][1] = (double)ADPCMVolTable[sbox.ADPCMVolume[ch][lr]] / 2.004348738e+03;
+   sbox.vf_xv[ch][lr][1] = in;
 
    sbox.vf_yv[ch][lr][0] = sbox.vf_yv[ch][lr][1]; 
    sbox.vf_yv[ch][lr][1] = (sbox.vf_xv[ch][lr][0] + sbox.vf_xv[ch][lr][1]) + (  0.9990021696 * sbox.vf_yv[ch][lr][0]);
@@ -275,150 +275,205 @@ static const int16 ADPCM_PhaseFilter[8][7] =
  /*   7 */ {     1,    56,   331,   683,   654,   283,    40 }, //  2048
 };
 
-v810_timestamp_t SoundBox_ADPCMUpdate(const v810_timestamp_t timestamp)
-{
-   int32 run_time = timestamp - adpcm_lastts;
+// Maximum number of ADPCM ticks the next update may be put off by when no KING ADPCM fetch is due.
+#define ADPCM_MAX_DEFER 256
 
-   adpcm_lastts = timestamp;
-
-   sbox.bigdiv -= run_time * 2;
+static INLINE void ADPCM_DecodeNibble(int ch)
+{
+   if(!sbox.ADPCMWhichNibble[ch])
+   {
+      sbox.ADPCMHalfWord[ch] = KING_GetADPCMHalfWord(ch);
+      sbox.ADPCMHaveHalfWord[ch] = TRUE;
+   }
 
-   while(sbox.bigdiv <= 0)
+   // If the channel's reset bit is set, don't update its ADPCM state.
+   if(sbox.ADPCMControl & (0x10 << ch))
    {
-      sbox.smalldiv--;
-      while(sbox.smalldiv <= 0)
+      sbox.ADPCMDelta[ch] = 0;
+   }
+   else
+   {
+      uint8 nibble = (sbox.ADPCMHalfWord[ch] >> (sbox.ADPCMWhichNibble[ch])) & 0xF;
+      int32 BaseStepSize = StepSizes[sbox.StepSizeIndex[ch]];
+
+      if(EmulateBuggyCodec)
       {
-         sbox.smalldiv += 1 << ((KINGADPCMControl >> 2) & 0x3);
-         for(int ch = 0; ch < 2; ch++)
-         {
-            // Keep playing our last halfword fetched even if KING ADPCM is disabled
-            if(sbox.ADPCMHaveHalfWord[ch] || KINGADPCMControl & (1 << ch)) 
-            {
-               if(!sbox.ADPCMWhichNibble[ch])
-               {
-                  sbox.ADPCMHalfWord[ch] = KING_GetADPCMHalfWord(ch);
-                  sbox.ADPCMHaveHalfWord[ch] = TRUE;
-               }
+         if(BaseStepSize == 1552)
+            BaseStepSize = 1522;
 
-               // If the channel's reset bit is set, don't update its ADPCM state.
-               if(sbox.ADPCMControl & (0x10 << ch))
-               {
-                  sbox.ADPCMDelta[ch] = 0;
-               }
-               else
-               {
-                  uint8 nibble = (sbox.ADPCMHalfWord[ch] >> (sbox.ADPCMWhichNibble[ch])) & 0xF;
-                  int32 BaseStepSize = StepSizes[sbox.StepSizeIndex[ch]];
+         sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1) * 2;
+      }
+      else
+         sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1);
 
-                  if(EmulateBuggyCodec)
-                  {
-                     if(BaseStepSize == 1552)
-                        BaseStepSize = 1522;
+      // Linear interpolation turned on?
+      if(sbox.ADPCMControl & (0x4 << ch))
+         sbox.ADPCMDelta[ch] >>= (KINGADPCMControl >> 2) & 0x3;
 
-                     sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1) * 2;
-                  }
-                  else
-                     sbox.ADPCMDelta[ch] = BaseStepSize * ((nibble & 0x7) + 1);
+      if(nibble & 0x8)
+         sbox.ADPCMDelta[ch] = -sbox.ADPCMDelta[ch];
 
-                  // Linear interpolation turned on?
-                  if(sbox.ADPCMControl & (0x4 << ch))
-                     sbox.ADPCMDelta[ch] >>= (KINGADPCMControl >> 2) & 0x3;
+      sbox.StepSizeIndex[ch] += StepIndexDeltas[nibble];
 
-                  if(nibble & 0x8)
-                     sbox.ADPCMDelta[ch] = -sbox.ADPCMDelta[ch];
+      if(sbox.StepSizeIndex[ch] < 0)
+         sbox.StepSizeIndex[ch] = 0;
 
-                  sbox.StepSizeIndex[ch] += StepIndexDeltas[nibble];
+      if(sbox.StepSizeIndex[ch] > 48)
+         sbox.StepSizeIndex[ch] = 48;
+   }
+   sbox.ADPCMHaveDelta[ch] = 1;
 
-                  if(sbox.StepSizeIndex[ch] < 0)
-                     sbox.StepSizeIndex[ch] = 0;
+   // Linear interpolation turned on?
+   if(sbox.ADPCMControl & (0x4 << ch))
+      sbox.ADPCMHaveDelta[ch] = 1 << ((KINGADPCMControl >> 2) & 0x3);
 
-                  if(sbox.StepSizeIndex[ch] > 48)
-                     sbox.StepSizeIndex[ch] = 48;
-               }
-               sbox.ADPCMHaveDelta[ch] = 1;
+   sbox.ADPCMWhichNibble[ch] = (sbox.ADPCMWhichNibble[ch] + 4) & 0xF;
 
-               // Linear interpolation turned on?
-               if(sbox.ADPCMControl & (0x4 << ch))
-                  sbox.ADPCMHaveDelta[ch] = 1 << ((KINGADPCMControl >> 2) & 0x3);
+   if(!sbox.ADPCMWhichNibble[ch])
+      sbox.ADPCMHaveHalfWord[ch] = FALSE;
+}
 
-               sbox.ADPCMWhichNibble[ch] = (sbox.ADPCMWhichNibble[ch] + 4) & 0xF;
+//
+// Runs the ticks that fell due since the last update in one batch, a channel at a time.  The channels only share the nibble clock(smalldiv), and
+// the KING rate bits can't change within an update(register writes catch us up first), so the nibble schedule is worked out up front.
+//
+// The only state visible outside the sound box that changes between updates is KING's, on a halfword fetch(play address, status, IRQ), so the
+// next update is scheduled for the tick of the next fetch rather than for every tick.
+//
+v810_timestamp_t SoundBox_ADPCMUpdate(const v810_timestamp_t timestamp)
+{
+   int32 run_time = timestamp - adpcm_lastts;
 
-               if(!sbox.ADPCMWhichNibble[ch])
-                  sbox.ADPCMHaveHalfWord[ch] = FALSE;
-            }
-         } // for(int ch...)
-      } // while(sbox.smalldiv <= 0)
+   adpcm_lastts = timestamp;
 
-      const uint32 synthtime42 = (timestamp << 1) + sbox.bigdiv;
-      const uint32 synthtime14 = synthtime42 / 3;
-      const uint32 synthtime = synthtime14 >> 3;
-      const unsigned synthtime_phase = synthtime14 & 7;
+   sbox.bigdiv -= run_time * 2;
 
-      for(int ch = 0; ch < 2; ch++)
+   while(sbox.bigdiv <= 0)
+   {
+      uint8 decodes[ADPCM_MAX_DEFER];
+      const int32 nibble_div = 1 << ((KINGADPCMControl >> 2) & 0x3);
+      const unsigned count = std::min<int32>(ADPCM_MAX_DEFER, -sbox.bigdiv / 1365 + 1);
+
+      for(unsigned i = 0; i < count; i++)
       {
-         if(sbox.ADPCMHaveDelta[ch]) 
+         unsigned k = 0;
+
+         sbox.smalldiv--;
+         if(sbox.smalldiv <= 0)
          {
-            sbox.ADPCMPredictor[ch] += sbox.ADPCMDelta[ch];
+            k = -sbox.smalldiv / nibble_div + 1;
+            sbox.smalldiv += k * nibble_div;
+         }
+         decodes[i] = k;
+      }
 
-            sbox.ADPCMHaveDelta[ch]--;
+      // 1365 / 3 == 455, so the 14.318MHz synth time advances by exactly 455 per tick.
+      const uint32 synthtime14_base = ((timestamp << 1) + sbox.bigdiv) / 3;
 
-            if(sbox.ADPCMPredictor[ch] > 0x3FFF) { sbox.ADPCMPredictor[ch] = 0x3FFF; }
-            if(sbox.ADPCMPredictor[ch] < -0x4000) { sbox.ADPCMPredictor[ch] = -0x4000;  }
-         }
-         else
-         {
+      for(int ch = 0; ch < 2; ch++)
+      {
+         bool vf_settled[2];
+         double vf_in[2];
 
+         for(int lr = 0; lr < 2; lr++)
+         {
+            vf_in[lr] = (double)ADPCMVolTable[sbox.ADPCMVolume[ch][lr]] / 2.004348738e+03;
+            vf_settled[lr] = false;
          }
 
-         if(SoundEnabled)
+         for(unsigned i = 0; i < count; i++)
          {
-            int32 samp[2];
-
-            if(EmulateBuggyCodec)
+            for(unsigned k = decodes[i]; k; k--)
             {
-               samp[0] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][0]);
-               samp[1] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][1]);
+               // Keep playing our last halfword fetched even if KING ADPCM is disabled
+               if(sbox.ADPCMHaveHalfWord[ch] || KINGADPCMControl & (1 << ch))
+                  ADPCM_DecodeNibble(ch);
             }
-            else
+
+            if(sbox.ADPCMHaveDelta[ch])
             {
-               samp[0] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][0]);
-               samp[1] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][1]);
+               sbox.ADPCMPredictor[ch] += sbox.ADPCMDelta[ch];
+
+               sbox.ADPCMHaveDelta[ch]--;
+
+               if(sbox.ADPCMPredictor[ch] > 0x3FFF) { sbox.ADPCMPredictor[ch] = 0x3FFF; }
+               if(sbox.ADPCMPredictor[ch] < -0x4000) { sbox.ADPCMPredictor[ch] = -0x4000;  }
             }
-            for(unsigned y = 0; y < 2; y++)
+
+            if(SoundEnabled)
             {
-               const int32 delta = samp[y] - sbox.ADPCM_last[ch][y];
-               int32* tb = FXsbuf[y]->Buf() + (synthtime & 0xFFFF);
-               const int16* coeffs = ADPCM_PhaseFilter[synthtime_phase];
+               const uint32 synthtime14 = synthtime14_base + i * 455;
+               const uint32 synthtime = synthtime14 >> 3;
+               const unsigned synthtime_phase = synthtime14 & 7;
+               int32 samp[2];
 
-               for(unsigned c = 0; c < 7; c++)
+               if(EmulateBuggyCodec)
+               {
+                  samp[0] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][0]);
+                  samp[1] = (int32)(((sbox.ADPCMPredictor[ch] >> 1) + (sbox.ResetAntiClick[ch] >> 33)) * sbox.VolumeFiltered[ch][1]);
+               }
+               else
+               {
+                  samp[0] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][0]);
+                  samp[1] = (int32)((sbox.ADPCMPredictor[ch] + (sbox.ResetAntiClick[ch] >> 32)) * sbox.VolumeFiltered[ch][1]);
+               }
+               for(unsigned y = 0; y < 2; y++)
                {
-                  int32 tmp = delta * coeffs[c];
+                  const int32 delta = samp[y] - sbox.ADPCM_last[ch][y];
 
-                  tb[c] += tmp;
+                  if(!delta)
+                     continue;
+
+                  int32* tb = FXsbuf[y]->Buf() + (synthtime & 0xFFFF);
+                  const int16* coeffs = ADPCM_PhaseFilter[synthtime_phase];
+
+                  for(unsigned c = 0; c < 7; c++)
+                  {
+                     int32 tmp = delta * coeffs[c];
+
+                     tb[c] += tmp;
+                  }
                }
+
+               sbox.ADPCM_last[ch][0] = samp[0];
+               sbox.ADPCM_last[ch][1] = samp[1];
             }
 
-            sbox.ADPCM_last[ch][0] = samp[0];
-            sbox.ADPCM_last[ch][1] = samp[1];
+            sbox.ResetAntiClick[ch] -= sbox.ResetAntiClick[ch] >> 8;
+
+            // Once the volume filter's input and output have both stopped changing, further steps leave it exactly where it is.
+            for(int lr = 0; lr < 2; lr++)
+            {
+               if(vf_settled[lr])
+                  continue;
+
+               DoVolumeFilter(ch, lr, vf_in[lr]);
+
+               vf_settled[lr] = sbox.vf_xv[ch][lr][0] == vf_in[lr] && sbox.vf_yv[ch][lr][0] == sbox.vf_yv[ch][lr][1];
+            }
          }
       }
+      sbox.bigdiv += count * 1365;
+   }
 
-      for(int ch = 0; ch < 2; ch++)
+   //
+   // Find the tick of the next halfword fetch on an enabled channel; until then, nothing outside the sound box can tell whether we've run.
+   //
+   int32 defer = ADPCM_MAX_DEFER;
+
+   for(int ch = 0; ch < 2; ch++)
+   {
+      if(KINGADPCMControl & (1 << ch))
       {
-         sbox.ResetAntiClick[ch] -= sbox.ResetAntiClick[ch] >> 8;
-         //if(ch)
-         // MDFN_DispMessage("%d", (int)(sbox.ResetAntiClick[ch] >> 32));
-      }
+         const int32 nibble_div = 1 << ((KINGADPCMControl >> 2) & 0x3);
+         const int32 nibbles = (sbox.ADPCMWhichNibble[ch] & 0xF) ? ((16 - (sbox.ADPCMWhichNibble[ch] & 0xF)) >> 2) + 1 : 1;
+         const int32 ticks = (sbox.smalldiv > 0) ? sbox.smalldiv + (nibbles - 1) * nibble_div : 1;
 
-      for(int ch = 0; ch < 2; ch++)
-         for(int lr = 0; lr < 2; lr++)
-         {
-            DoVolumeFilter(ch, lr);
-         }
-      sbox.bigdiv += 1365 * 2 / 2;
+         defer = std::min<int32>(defer, ticks);
+      }
    }
 
-   return(timestamp + (sbox.bigdiv + 1) / 2);
+   return(timestamp + (sbox.bigdiv + (defer - 1) * 1365 + 1) / 2);
 }
 
 int32 SoundBox_Flush(const v810_timestamp_t end_timestamp, v810_timestamp_t* new_base_timestamp, int16 *SoundBuf, const int32 MaxSoundFrames)
@@ -433,18 +488,21 @@ int32 SoundBox_Flush(const v810_timestamp_t end_timestamp, v810_timestamp_t* new
 
    pce_psg->Update(end_timestamp_div3);
 
-   for(unsigned y = 0; y < 2; y++)
+   if(SoundEnabled && FXres)
    {
-      if(SoundEnabled && FXres)
-      {
+      for(unsigned y = 0; y < 2; y++)
          FXsbuf[y]->Integrate(rsc, 0, 0, FXCDDABufs[y]);
-         FrameCount = FXres->Resample(FXsbuf[y], rsc, SoundBuf + y, MaxSoundFrames);
-      }
-      else
+
+      FrameCount = FXres->ResampleStereo(FXsbuf[0], FXsbuf[1], rsc, SoundBuf, MaxSoundFrames);
+   }
+   else
+   {
+      for(unsigned y = 0; y < 2; y++)
          FXsbuf[y]->ResampleSkipped(rsc);
+   }
 
+   for(unsigned y = 0; y < 2; y++)
       FXCDDABufs[y]->Finish(rsc);
-   }
 
    return(FrameCount);
 }
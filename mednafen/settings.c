@@ -27,9 +27,17 @@ int setting_last_scanline = 239;
 int setting_high_dotclock_width = 1024;
 int setting_nospritelimit = 0;
 int setting_resamp_quality = 3;
+int setting_audio_rate = 44100;
 int setting_suppress_channel_reset_clicks = 1;
 int setting_emulate_buggy_codec = 0;
 int setting_rainbow_chromaip = 0;
+int setting_rainbow_threaded = 0;
+int setting_rainbow_cache_size = 0;
+int setting_cdda_cache_size = 0;
+int setting_cd_readahead_size = 256;
+int setting_chd_cache_hunks = 64;
+int setting_chd_prefetch_hunks = 4;
+int setting_cd_block_cache_size = 0;
 
 uint64_t MDFN_GetSettingUI(const char *name)
 {
@@ -43,6 +51,18 @@ uint64_t MDFN_GetSettingUI(const char *name)
       return setting_high_dotclock_width;
    if (!strcmp("pcfx.resamp_quality", name))
       return setting_resamp_quality;
+   if (!strcmp("pcfx.cdda_cache_size", name))
+      return setting_cdda_cache_size;
+   if (!strcmp("pcfx.cd_readahead_size", name))
+      return setting_cd_readahead_size;
+   if (!strcmp("pcfx.chd_cache_hunks", name))
+      return setting_chd_cache_hunks;
+   if (!strcmp("pcfx.chd_prefetch_hunks", name))
+      return setting_chd_prefetch_hunks;
+   if (!strcmp("pcfx.cd_block_cache_size", name))
+      return setting_cd_block_cache_size;
+   if (!strcmp("pcfx.rainbow.cache_size", name))
+      return setting_rainbow_cache_size;
    return 0;
 }
 
@@ -85,6 +105,8 @@ bool MDFN_GetSettingB(const char *name)
       return setting_emulate_buggy_codec;
    if (!strcmp("pcfx.rainbow.chromaip", name))
       return setting_rainbow_chromaip;
+   if (!strcmp("pcfx.rainbow.threaded", name))
+      return setting_rainbow_threaded;
    /* CDROM */
    if (!strcmp("cdrom.lec_eval", name))
       return 1;
@@ -13,9 +13,17 @@ extern int setting_last_scanline;
 extern int setting_high_dotclock_width;
 extern int setting_nospritelimit;
 extern int setting_resamp_quality;
+extern int setting_audio_rate;
 extern int setting_suppress_channel_reset_clicks;
 extern int setting_emulate_buggy_codec;
 extern int setting_rainbow_chromaip;
+extern int setting_rainbow_threaded;
+extern int setting_rainbow_cache_size;
+extern int setting_cdda_cache_size;
+extern int setting_cd_readahead_size;
+extern int setting_chd_cache_hunks;
+extern int setting_chd_prefetch_hunks;
+extern int setting_cd_block_cache_size;
 
 // This should assert() or something if the setting isn't found, since it would
 // be a totally tubular error!
@@ -38,6 +38,20 @@ extern retro_get_cpu_features_t perf_get_cpu_features_cb;
  #include <altivec.h>
 #endif
 
+#if defined(__SSE2__)
+ #include <emmintrin.h>
+#endif
+
+#if defined(ARCH_X86) && defined(__GNUC__)
+ #define OWLRESAMP_AVX2
+ #include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+ #define OWLRESAMP_NEON
+ #include <arm_neon.h>
+#endif
+
 #ifdef __FAST_MATH__
  #error "OwlResampler.cpp not compatible with unsafe math optimizations!"
 #endif
@@ -289,6 +303,26 @@ static INLINE void DoMAC(float *wave, float *coeffs, int32 count, int32 *accum_o
  *accum_output = (acc[0] + acc[2]) + (acc[1] + acc[3]);
 }
 
+// Stereo versions of the MAC kernels, which share each coefficient load between the two channels.  Each channel's sums
+// are accumulated in the same order as in the mono version, so the results are identical.
+static INLINE void DoMAC2(float *wave_l, float *wave_r, float *coeffs, int32 count, int32 *accum_l, int32 *accum_r)
+{
+ float acc_l[4] = { 0, 0, 0, 0 };
+ float acc_r[4] = { 0, 0, 0, 0 };
+
+ for(int c = 0; c < count; c += 4)
+ {
+  for(int i = 0; i < 4; i++)
+  {
+   acc_l[i] += wave_l[c + i] * coeffs[c + i];
+   acc_r[i] += wave_r[c + i] * coeffs[c + i];
+  }
+ }
+
+ *accum_l = (acc_l[0] + acc_l[2]) + (acc_l[1] + acc_l[3]);
+ *accum_r = (acc_r[0] + acc_r[2]) + (acc_r[1] + acc_r[3]);
+}
+
 #if defined(ARCH_X86)
 
 #if defined(__x86_64__) && !defined(__ILP32__)
@@ -382,7 +416,197 @@ static INLINE void DoMAC_SSE(float *wave, float *coeffs, int32 count, int32 *acc
 #endif
 );
 }
-#elif defined(ARCH_POWERPC_ALTIVEC)
+#endif
+
+#if defined(OWLRESAMP_AVX2)
+static __attribute__((target("avx2,fma"))) void DoMAC_AVX2(float *wave, float *coeffs, int32 count, int32 *accum_output)
+{
+ // Multiplies 32 coefficients at a time, then 16 for the remainder(count is a multiple of 16).
+ __m256 acc0 = _mm256_setzero_ps();
+ __m256 acc1 = _mm256_setzero_ps();
+ __m256 acc2 = _mm256_setzero_ps();
+ __m256 acc3 = _mm256_setzero_ps();
+ int32 c = 0;
+
+ for(; (c + 32) <= count; c += 32)
+ {
+  acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(wave + c +  0), _mm256_loadu_ps(coeffs + c +  0), acc0);
+  acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(wave + c +  8), _mm256_loadu_ps(coeffs + c +  8), acc1);
+  acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(wave + c + 16), _mm256_loadu_ps(coeffs + c + 16), acc2);
+  acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(wave + c + 24), _mm256_loadu_ps(coeffs + c + 24), acc3);
+ }
+
+ if(c < count)
+ {
+  acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(wave + c + 0), _mm256_loadu_ps(coeffs + c + 0), acc0);
+  acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(wave + c + 8), _mm256_loadu_ps(coeffs + c + 8), acc1);
+ }
+
+ {
+  const __m256 sum = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+
+  *accum_output = _mm_cvtss_si32(s);
+ }
+}
+#endif
+
+#if defined(ARCH_X86) && defined(__SSE2__)
+static INLINE int32 HSum_SSE(const __m128 acc0, const __m128 acc1, const __m128 acc2, const __m128 acc3)
+{
+ __m128 sum = _mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3));
+
+ sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, 27));
+ sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+
+ return(_mm_cvtss_si32(sum));
+}
+
+static INLINE void DoMAC2_SSE(float *wave_l, float *wave_r, float *coeffs, int32 count, int32 *accum_l, int32 *accum_r)
+{
+ // Multiplies 16 coefficients at a time, per channel.
+ __m128 l0 = _mm_setzero_ps(), l1 = l0, l2 = l0, l3 = l0;
+ __m128 r0 = l0, r1 = l0, r2 = l0, r3 = l0;
+
+ for(int32 c = 0; c < count; c += 16)
+ {
+  const __m128 c0 = _mm_load_ps(coeffs + c +  0);
+  const __m128 c1 = _mm_load_ps(coeffs + c +  4);
+  const __m128 c2 = _mm_load_ps(coeffs + c +  8);
+  const __m128 c3 = _mm_load_ps(coeffs + c + 12);
+
+  l0 = _mm_add_ps(l0, _mm_mul_ps(_mm_loadu_ps(wave_l + c +  0), c0));
+  r0 = _mm_add_ps(r0, _mm_mul_ps(_mm_loadu_ps(wave_r + c +  0), c0));
+  l1 = _mm_add_ps(l1, _mm_mul_ps(_mm_loadu_ps(wave_l + c +  4), c1));
+  r1 = _mm_add_ps(r1, _mm_mul_ps(_mm_loadu_ps(wave_r + c +  4), c1));
+  l2 = _mm_add_ps(l2, _mm_mul_ps(_mm_loadu_ps(wave_l + c +  8), c2));
+  r2 = _mm_add_ps(r2, _mm_mul_ps(_mm_loadu_ps(wave_r + c +  8), c2));
+  l3 = _mm_add_ps(l3, _mm_mul_ps(_mm_loadu_ps(wave_l + c + 12), c3));
+  r3 = _mm_add_ps(r3, _mm_mul_ps(_mm_loadu_ps(wave_r + c + 12), c3));
+ }
+
+ *accum_l = HSum_SSE(l0, l1, l2, l3);
+ *accum_r = HSum_SSE(r0, r1, r2, r3);
+}
+#endif
+
+#if defined(OWLRESAMP_AVX2)
+static __attribute__((target("avx2,fma"))) void DoMAC2_AVX2(float *wave_l, float *wave_r, float *coeffs, int32 count, int32 *accum_l, int32 *accum_r)
+{
+ __m256 l0 = _mm256_setzero_ps(), l1 = l0, l2 = l0, l3 = l0;
+ __m256 r0 = l0, r1 = l0, r2 = l0, r3 = l0;
+ int32 c = 0;
+
+ for(; (c + 32) <= count; c += 32)
+ {
+  const __m256 c0 = _mm256_loadu_ps(coeffs + c +  0);
+  const __m256 c1 = _mm256_loadu_ps(coeffs + c +  8);
+  const __m256 c2 = _mm256_loadu_ps(coeffs + c + 16);
+  const __m256 c3 = _mm256_loadu_ps(coeffs + c + 24);
+
+  l0 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_l + c +  0), c0, l0);
+  r0 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_r + c +  0), c0, r0);
+  l1 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_l + c +  8), c1, l1);
+  r1 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_r + c +  8), c1, r1);
+  l2 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_l + c + 16), c2, l2);
+  r2 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_r + c + 16), c2, r2);
+  l3 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_l + c + 24), c3, l3);
+  r3 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_r + c + 24), c3, r3);
+ }
+
+ if(c < count)
+ {
+  const __m256 c0 = _mm256_loadu_ps(coeffs + c + 0);
+  const __m256 c1 = _mm256_loadu_ps(coeffs + c + 8);
+
+  l0 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_l + c + 0), c0, l0);
+  r0 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_r + c + 0), c0, r0);
+  l1 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_l + c + 8), c1, l1);
+  r1 = _mm256_fmadd_ps(_mm256_loadu_ps(wave_r + c + 8), c1, r1);
+ }
+
+ {
+  const __m256 sum_l = _mm256_add_ps(_mm256_add_ps(l0, l1), _mm256_add_ps(l2, l3));
+  const __m256 sum_r = _mm256_add_ps(_mm256_add_ps(r0, r1), _mm256_add_ps(r2, r3));
+  __m128 s_l = _mm_add_ps(_mm256_castps256_ps128(sum_l), _mm256_extractf128_ps(sum_l, 1));
+  __m128 s_r = _mm_add_ps(_mm256_castps256_ps128(sum_r), _mm256_extractf128_ps(sum_r, 1));
+
+  s_l = _mm_add_ps(s_l, _mm_movehl_ps(s_l, s_l));
+  s_l = _mm_add_ss(s_l, _mm_shuffle_ps(s_l, s_l, 1));
+  s_r = _mm_add_ps(s_r, _mm_movehl_ps(s_r, s_r));
+  s_r = _mm_add_ss(s_r, _mm_shuffle_ps(s_r, s_r, 1));
+
+  *accum_l = _mm_cvtss_si32(s_l);
+  *accum_r = _mm_cvtss_si32(s_r);
+ }
+}
+#endif
+
+#if defined(OWLRESAMP_NEON)
+static INLINE void DoMAC_NEON(float *wave, float *coeffs, int32 count, int32 *accum_output)
+{
+ // Multiplies 16 coefficients at a time.
+ float32x4_t acc0 = vdupq_n_f32(0);
+ float32x4_t acc1 = acc0;
+ float32x4_t acc2 = acc0;
+ float32x4_t acc3 = acc0;
+
+ for(int32 c = 0; c < count; c += 16)
+ {
+  acc0 = vmlaq_f32(acc0, vld1q_f32(wave + c +  0), vld1q_f32(coeffs + c +  0));
+  acc1 = vmlaq_f32(acc1, vld1q_f32(wave + c +  4), vld1q_f32(coeffs + c +  4));
+  acc2 = vmlaq_f32(acc2, vld1q_f32(wave + c +  8), vld1q_f32(coeffs + c +  8));
+  acc3 = vmlaq_f32(acc3, vld1q_f32(wave + c + 12), vld1q_f32(coeffs + c + 12));
+ }
+
+ {
+  const float32x4_t sum = vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3));
+  const float32x2_t sum2 = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+
+  *accum_output = vget_lane_f32(vpadd_f32(sum2, sum2), 0);
+ }
+}
+#endif
+
+#if defined(OWLRESAMP_NEON)
+static INLINE void DoMAC2_NEON(float *wave_l, float *wave_r, float *coeffs, int32 count, int32 *accum_l, int32 *accum_r)
+{
+ float32x4_t l0 = vdupq_n_f32(0), l1 = l0, l2 = l0, l3 = l0;
+ float32x4_t r0 = l0, r1 = l0, r2 = l0, r3 = l0;
+
+ for(int32 c = 0; c < count; c += 16)
+ {
+  const float32x4_t c0 = vld1q_f32(coeffs + c +  0);
+  const float32x4_t c1 = vld1q_f32(coeffs + c +  4);
+  const float32x4_t c2 = vld1q_f32(coeffs + c +  8);
+  const float32x4_t c3 = vld1q_f32(coeffs + c + 12);
+
+  l0 = vmlaq_f32(l0, vld1q_f32(wave_l + c +  0), c0);
+  r0 = vmlaq_f32(r0, vld1q_f32(wave_r + c +  0), c0);
+  l1 = vmlaq_f32(l1, vld1q_f32(wave_l + c +  4), c1);
+  r1 = vmlaq_f32(r1, vld1q_f32(wave_r + c +  4), c1);
+  l2 = vmlaq_f32(l2, vld1q_f32(wave_l + c +  8), c2);
+  r2 = vmlaq_f32(r2, vld1q_f32(wave_r + c +  8), c2);
+  l3 = vmlaq_f32(l3, vld1q_f32(wave_l + c + 12), c3);
+  r3 = vmlaq_f32(r3, vld1q_f32(wave_r + c + 12), c3);
+ }
+
+ {
+  const float32x4_t sum_l = vaddq_f32(vaddq_f32(l0, l1), vaddq_f32(l2, l3));
+  const float32x4_t sum_r = vaddq_f32(vaddq_f32(r0, r1), vaddq_f32(r2, r3));
+  const float32x2_t sum2_l = vadd_f32(vget_low_f32(sum_l), vget_high_f32(sum_l));
+  const float32x2_t sum2_r = vadd_f32(vget_low_f32(sum_r), vget_high_f32(sum_r));
+
+  *accum_l = vget_lane_f32(vpadd_f32(sum2_l, sum2_l), 0);
+  *accum_r = vget_lane_f32(vpadd_f32(sum2_r, sum2_r), 0);
+ }
+}
+#endif
+
+#if defined(ARCH_POWERPC_ALTIVEC)
 static INLINE void DoMAC_AltiVec(float* wave, float* coeffs, int32 count, int32* accum_output)
 {
  register vector float acc0, acc1, acc2, acc3;
@@ -490,6 +714,98 @@ static T SDP2(T v)
  return ((v + tmp) >> sa);
 }
 
+static INLINE int16 ConvertSample(const int32 v)
+{
+ int32 s = SDP2<int32, 8>(v);
+
+ if(s < -32768 || s > 32767)
+ {
+  if(s < -32768)
+   s = -32768;
+  else if(s > 32767)
+   s = 32767;
+ }
+
+ return(s);
+}
+
+// Scales down and clamps the debiased samples in "in", storing them into every other int16 of "out" (the other channel's
+// samples in between are left alone).  The vector loops read and write back whole int16 pairs, so they stop one sample
+// short of the end; for the right channel("out" one past the start of the stereo buffer) the last pair would run past it.
+static void ConvertOutput(const int32* in, int16* out, const uint32 count)
+{
+ uint32 x = 0;
+
+#if defined(__SSE2__)
+ const __m128i keep = _mm_set1_epi32(0xFFFF0000);
+
+ for(; (x + 4) < count; x += 4)
+ {
+  __m128i s = _mm_loadu_si128((const __m128i*)&in[x]);
+
+  // SDP2<int32, 8>()
+  s = _mm_srai_epi32(_mm_add_epi32(s, _mm_srli_epi32(_mm_srai_epi32(s, 31), 24)), 8);
+  // Clamp to int16, and zero-extend back into 32-bit lanes so each lands in the even int16.
+  s = _mm_unpacklo_epi16(_mm_packs_epi32(s, s), _mm_setzero_si128());
+
+  _mm_storeu_si128((__m128i*)&out[x * 2], _mm_or_si128(_mm_and_si128(_mm_loadu_si128((const __m128i*)&out[x * 2]), keep), s));
+ }
+#elif defined(OWLRESAMP_NEON)
+ for(; (x + 4) < count; x += 4)
+ {
+  int32x4_t s = vld1q_s32(&in[x]);
+  int16x4x2_t o = vld2_s16(&out[x * 2]);
+
+  s = vshrq_n_s32(vaddq_s32(s, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(s, 31)), 24))), 8);
+  o.val[0] = vqmovn_s32(s);
+
+  vst2_s16(&out[x * 2], o);
+ }
+#endif
+
+ for(; x < count; x++)
+  out[x * 2] = ConvertSample(in[x]);
+}
+
+// Same as ConvertOutput(), for both channels at once.
+static void ConvertOutputStereo(const int32* in_l, const int32* in_r, int16* out, const uint32 count)
+{
+ uint32 x = 0;
+
+#if defined(__SSE2__)
+ for(; (x + 4) <= count; x += 4)
+ {
+  __m128i l = _mm_loadu_si128((const __m128i*)&in_l[x]);
+  __m128i r = _mm_loadu_si128((const __m128i*)&in_r[x]);
+
+  l = _mm_srai_epi32(_mm_add_epi32(l, _mm_srli_epi32(_mm_srai_epi32(l, 31), 24)), 8);
+  r = _mm_srai_epi32(_mm_add_epi32(r, _mm_srli_epi32(_mm_srai_epi32(r, 31), 24)), 8);
+
+  _mm_storeu_si128((__m128i*)&out[x * 2], _mm_unpacklo_epi16(_mm_packs_epi32(l, l), _mm_packs_epi32(r, r)));
+ }
+#elif defined(OWLRESAMP_NEON)
+ for(; (x + 4) <= count; x += 4)
+ {
+  int32x4_t l = vld1q_s32(&in_l[x]);
+  int32x4_t r = vld1q_s32(&in_r[x]);
+  int16x4x2_t o;
+
+  l = vshrq_n_s32(vaddq_s32(l, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(l, 31)), 24))), 8);
+  r = vshrq_n_s32(vaddq_s32(r, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(r, 31)), 24))), 8);
+  o.val[0] = vqmovn_s32(l);
+  o.val[1] = vqmovn_s32(r);
+
+  vst2_s16(&out[x * 2], o);
+ }
+#endif
+
+ for(; x < count; x++)
+ {
+  out[x * 2 + 0] = ConvertSample(in_l[x]);
+  out[x * 2 + 1] = ConvertSample(in_r[x]);
+ }
+}
+
 int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, const uint32 max_out_count)
 {
 	uint32 count = 0;
@@ -510,11 +826,24 @@ int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, c
       int32 coeff_count = NumCoeffs;
 
 #ifdef ARCH_X86
+#if defined(OWLRESAMP_AVX2)
+      if(UseAVX2FMA)
+      {
+         DoMAC_AVX2(wave, coeffs, coeff_count, I32Out);
+         handled = true;
+      }
+      else
+#endif
       if(cpuext & RETRO_SIMD_SSE2)
       {
          DoMAC_SSE(wave, coeffs, coeff_count, I32Out);
          handled = true;
       }
+#elif defined(OWLRESAMP_NEON)
+      {
+         DoMAC_NEON(wave, coeffs, coeff_count, I32Out);
+         handled = true;
+      }
 #elif defined(ARCH_POWERPC_ALTIVEC)
       {
          DoMAC_AltiVec(wave, coeffs, coeff_count, I32Out);
@@ -543,30 +872,123 @@ int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, c
       InputIndex = 0;
    }
 
+   Debias(in, boobuf, count);
+   ConvertOutput(boobuf, out, count);
+
+   FinishBuffer(in, in_count, leftover, InputPhase, InputIndex);
+
+	return(count);
+}
+
+// Resamples a left and right buffer together, convolving both channels with each coefficient load, and writes
+// interleaved output.  The two buffers must have been fed the same way(as they are in a stereo stream), so that they're
+// in the same resampling state.
+int32 OwlResampler::ResampleStereo(OwlBuffer* in_l, OwlBuffer* in_r, const uint32 in_count, int16* out, const uint32 max_out_count)
+{
+#if defined(ARCH_POWERPC_ALTIVEC)
+   const bool fused = false;	// No stereo AltiVec kernel.
+#else
+   const bool fused = true;
+#endif
+
+   if(!fused || in_l->leftover != in_r->leftover || in_l->InputPhase != in_r->InputPhase || in_l->InputIndex != in_r->InputIndex)
    {
-      int64 debias = in->debias;
+      Resample(in_l, in_count, out + 0, max_out_count);
+
+      return(Resample(in_r, in_count, out + 1, max_out_count));
+   }
 
-      for(uint32 x = 0; x < count; x++)
+	uint32 count = 0;
+	int32 *boobuf_l = &IntermediateBuffer[0];
+	int32 *boobuf_r = &IntermediateBuffer[IntermediateBuffer.size() / 2];
+	const uint32 in_count_WLO = in_l->leftover + in_count;
+	const uint32 max = std::max<int64>(0, (int64)in_count_WLO - NumCoeffs);
+        uint32 InputPhase = in_l->InputPhase;
+        uint32 InputIndex = in_l->InputIndex;
+	OwlBuffer::I32_F_Pudding* InSamps_l = in_l->BufPudding() - in_l->leftover;
+	OwlBuffer::I32_F_Pudding* InSamps_r = in_r->BufPudding() - in_r->leftover;
+	int32 leftover;
+
+   while(InputIndex < max)
+   {
+      bool handled      = false;
+      float* wave_l     = &InSamps_l[InputIndex].f;
+      float* wave_r     = &InSamps_r[InputIndex].f;
+      float* coeffs     = &FIR_Coeffs[InputPhase][0].f;
+      int32 coeff_count = NumCoeffs;
+
+#ifdef ARCH_X86
+#if defined(OWLRESAMP_AVX2)
+      if(UseAVX2FMA)
+      {
+         DoMAC2_AVX2(wave_l, wave_r, coeffs, coeff_count, &boobuf_l[count], &boobuf_r[count]);
+         handled = true;
+      }
+      else
+#endif
+#if defined(__SSE2__)
+      if(cpuext & RETRO_SIMD_SSE2)
       {
-         int32 sample = boobuf[x];
-         int32 s;
-
-         debias += ((((int64)sample << 16) - debias) * debias_multiplier) >> 16;
-         s = SDP2<int32, 8>(sample - (debias >> 16));
-
-         if(s < -32768 || s > 32767)
-         {
-            if(s < -32768)
-               s = -32768;
-            else if(s > 32767)
-               s = 32767;
-         }
-         out[x * 2] = s;
+         DoMAC2_SSE(wave_l, wave_r, coeffs, coeff_count, &boobuf_l[count], &boobuf_r[count]);
+         handled = true;
+      }
+#endif
+#elif defined(OWLRESAMP_NEON)
+      {
+         DoMAC2_NEON(wave_l, wave_r, coeffs, coeff_count, &boobuf_l[count], &boobuf_r[count]);
+         handled = true;
       }
+#endif
+
+      if (!handled)
+         DoMAC2(wave_l, wave_r, coeffs, coeff_count, &boobuf_l[count], &boobuf_r[count]);
+
+      count++;
+
+      InputPhase = PhaseNext[InputPhase];
+      InputIndex += PhaseStep[InputPhase];
+   }
 
-      in->debias = debias;
+   if(InputIndex > in_count_WLO)
+   {
+      leftover = 0;
+      InputIndex -= in_count_WLO;
    }
+   else
+   {
+      leftover = (int32)in_count_WLO - (int32)InputIndex;
+      InputIndex = 0;
+   }
+
+   Debias(in_l, boobuf_l, count);
+   Debias(in_r, boobuf_r, count);
+   ConvertOutputStereo(boobuf_l, boobuf_r, out, count);
 
+   FinishBuffer(in_l, in_count, leftover, InputPhase, InputIndex);
+   FinishBuffer(in_r, in_count, leftover, InputPhase, InputIndex);
+
+	return(count);
+}
+
+// The debias filter is a recurrence, so it stays scalar; the rest of the conversion to output samples is done
+// separately.
+void OwlResampler::Debias(OwlBuffer* in, int32* buf, const uint32 count)
+{
+ int64 debias = in->debias;
+
+ for(uint32 x = 0; x < count; x++)
+ {
+  int32 sample = buf[x];
+
+  debias += ((((int64)sample << 16) - debias) * debias_multiplier) >> 16;
+  buf[x] = sample - (debias >> 16);
+ }
+
+ in->debias = debias;
+}
+
+void OwlResampler::FinishBuffer(OwlBuffer* in, const uint32 in_count, const int32 leftover, const uint32 InputPhase, const uint32 InputIndex)
+{
    memmove(in->Buf() - leftover,
          in->Buf() + in_count - leftover,
          sizeof(int32) * (leftover + OwlBuffer::HRBUF_OVERFLOW_PADDING));
@@ -576,8 +998,6 @@ int32 OwlResampler::Resample(OwlBuffer* in, const uint32 in_count, int16* out, c
 	in->leftover = leftover;
 	in->InputPhase = InputPhase;
 	in->InputIndex = InputIndex;
-
-	return(count);
 }
 
 void OwlResampler::ResetBufResampState(OwlBuffer* buf)
@@ -644,12 +1064,22 @@ OwlResampler::OwlResampler(double input_rate, double output_rate, double rate_er
  DebiasCorner = debias_corner;
  Quality = quality;
 
- IntermediateBuffer.resize(OutputRate * 4 / 50);	// *4 for safety padding, / min(50,60), an approximate calculation
+ IntermediateBuffer.resize(OutputRate * 4 / 50 * 2);	// *4 for safety padding, / min(50,60), an approximate calculation, *2 for ResampleStereo()
 
  cpuext = 0;
  if (perf_get_cpu_features_cb)
     cpuext = perf_get_cpu_features_cb();
 
+ // The frontend doesn't report FMA separately, so ask the compiler's runtime.
+ UseAVX2FMA = false;
+#if defined(OWLRESAMP_AVX2)
+ if(cpuext & RETRO_SIMD_AVX2)
+ {
+  __builtin_cpu_init();
+  UseAVX2FMA = __builtin_cpu_supports("fma");
+ }
+#endif
+
  // Get the number of phases required, and adjust ratio.
  {
   double s_ratio = (double)input_rate / output_rate;
@@ -737,10 +1167,18 @@ OwlResampler::OwlResampler(double input_rate, double output_rate, double rate_er
   abort();	// The sky is falling AAAAAAAAAAAAA
  }
  #ifdef ARCH_X86
- else if(cpuext & RETRO_SIMD_SSE2)
+ else if(UseAVX2FMA || (cpuext & RETRO_SIMD_SSE2))
  {
 
-  // SSE loop does 16 MACs per iteration.
+  // SSE loop does 16 MACs per iteration, AVX2 loop does 32 or 16.
+  NumCoeffs = (NumCoeffs + 15) &~ 15;
+  NumCoeffs_Padded = NumCoeffs;
+ }
+ #endif
+ #ifdef OWLRESAMP_NEON
+ else if(1)
+ {
+  // NEON loop does 16 MACs per iteration.
   NumCoeffs = (NumCoeffs + 15) &~ 15;
   NumCoeffs_Padded = NumCoeffs;
  }
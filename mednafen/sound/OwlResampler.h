@@ -101,6 +101,7 @@ class OwlResampler
 	~OwlResampler() MDFN_COLD;
 
 	int32 Resample(OwlBuffer* in, const uint32 in_count, int16* out, const uint32 max_out_count);
+	int32 ResampleStereo(OwlBuffer* in_l, OwlBuffer* in_r, const uint32 in_count, int16* out, const uint32 max_out_count);
 	void ResetBufResampState(OwlBuffer* buf);
 
 	// Get the InputRate / OutputRate ratio, expressed as a / b
@@ -112,6 +113,9 @@ class OwlResampler
 
 	private:
 
+	void Debias(OwlBuffer* in, int32* buf, const uint32 count);
+	static void FinishBuffer(OwlBuffer* in, const uint32 in_count, const int32 leftover, const uint32 InputPhase, const uint32 InputIndex);
+
 	// Copy of the parameters passed to the constructor
 	double InputRate, OutputRate, RateError, DebiasCorner;
 	int Quality;
@@ -140,6 +144,7 @@ class OwlResampler
 	std::vector<int32> IntermediateBuffer; //int32 boobuf[8192];
 
 	uint32 cpuext;
+	bool UseAVX2FMA;
 
 	uint16 debias_multiplier;
 
@@ -269,6 +269,17 @@ void vorbis_dsp_clear(vorbis_dsp_state *v){
   }
 }
 
+/* overlap/add helper */
+static INLINE void _vorbis_add(int32_t *pcm,const int32_t *p,int n){
+  int i=0;
+#ifdef _V_SIMD
+  for(;i+4<=n;i+=4)
+    VSTORE(pcm+i,VADD(VLOAD(pcm+i),VLOAD(p+i)));
+#endif
+  for(;i<n;i++)
+    pcm[i]+=p[i];
+}
+
 /* Unlike in analysis, the window is only partially applied for each
    block.  The time domain envelope is not yet handled at the point of
    calling (as it relies on the previous block). */
@@ -323,30 +334,26 @@ int vorbis_synthesis_blockin(vorbis_dsp_state *v,vorbis_block *vb){
 	  /* large/large */
 	  int32_t *pcm=v->pcm[j]+prevCenter;
 	  int32_t *p=vb->pcm[j];
-	  for(i=0;i<n1;i++)
-	    pcm[i]+=p[i];
+	  _vorbis_add(pcm,p,n1);
 	}else{
 	  /* large/small */
 	  int32_t *pcm=v->pcm[j]+prevCenter+n1/2-n0/2;
 	  int32_t *p=vb->pcm[j];
-	  for(i=0;i<n0;i++)
-	    pcm[i]+=p[i];
+	  _vorbis_add(pcm,p,n0);
 	}
       }else{
 	if(v->W){
 	  /* small/large */
 	  int32_t *pcm=v->pcm[j]+prevCenter;
 	  int32_t *p=vb->pcm[j]+n1/2-n0/2;
-	  for(i=0;i<n0;i++)
-	    pcm[i]+=p[i];
-	  for(;i<n1/2+n0/2;i++)
+	  _vorbis_add(pcm,p,n0);
+	  for(i=n0;i<n1/2+n0/2;i++)
 	    pcm[i]=p[i];
 	}else{
 	  /* small/small */
 	  int32_t *pcm=v->pcm[j]+prevCenter;
 	  int32_t *p=vb->pcm[j];
-	  for(i=0;i<n0;i++)
-	    pcm[i]+=p[i];
+	  _vorbis_add(pcm,p,n0);
 	}
       }
       
@@ -144,6 +144,85 @@ static INLINE void mdct_butterfly_32(DATA_TYPE *x){
 	   mdct_butterfly_16(x+16);
 }
 
+#ifdef _V_SIMD
+/* Four pairs of the generic butterfly at once.  Pair k (x[2k], x[2k+1])
+   uses the trig values in lane k of c and s.  neg_e/neg_o negate the
+   even/odd differences, swap exchanges the operands and xn selects
+   XNPROD31 over XPROD31, giving the four quarter-loops below; the
+   arithmetic is the same as the scalar code's. */
+static INLINE void mdct_butterfly_v4(DATA_TYPE *x1,DATA_TYPE *x2,
+				     vint32_t c,vint32_t s,
+				     int neg_e,int neg_o,int swap,int xn){
+  vint32_t a0 = VLOAD(x1);
+  vint32_t a1 = VLOAD(x1+4);
+  vint32_t b0 = VLOAD(x2);
+  vint32_t b1 = VLOAD(x2+4);
+  vint32_t de, d_o, p, q, oe, oo;
+
+  VSTORE(x1,   VADD(a0, b0));
+  VSTORE(x1+4, VADD(a1, b1));
+
+  VUNZIP(VSUB(a0, b0), VSUB(a1, b1), de, d_o);
+  if(neg_e) de  = VNEG(de);
+  if(neg_o) d_o = VNEG(d_o);
+
+  p = swap ? d_o : de;
+  q = swap ? de : d_o;
+
+  if(xn){
+    oe = VSUB(VMULT31(p, c), VMULT31(q, s));
+    oo = VADD(VMULT31(q, c), VMULT31(p, s));
+  }else{
+    oe = VADD(VMULT31(p, c), VMULT31(q, s));
+    oo = VSUB(VMULT31(q, c), VMULT31(p, s));
+  }
+
+  VZIP(oe, oo, a0, a1);
+  VSTORE(x2,   a0);
+  VSTORE(x2+4, a1);
+}
+
+/* N/stage point generic N stage butterfly (in place) */
+static INLINE void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
+
+  LOOKUP_T *T   = sincos_lookup0;
+  DATA_TYPE *x1        = x + points      - 8;
+  DATA_TYPE *x2        = x + (points>>1) - 8;
+
+  do{
+    mdct_butterfly_v4(x1, x2,
+		      VSET(T[step*3], T[step*2], T[step], T[0]),
+		      VSET(T[step*3+1], T[step*2+1], T[step+1], T[1]),
+		      0, 1, 1, 0);
+    T+=step*4;
+    x1-=8; x2-=8;
+  }while(T<sincos_lookup0+1024);
+  do{
+    mdct_butterfly_v4(x1, x2,
+		      VSET(T[-step*3], T[-step*2], T[-step], T[0]),
+		      VSET(T[-step*3+1], T[-step*2+1], T[-step+1], T[1]),
+		      0, 0, 0, 1);
+    T-=step*4;
+    x1-=8; x2-=8;
+  }while(T>sincos_lookup0);
+  do{
+    mdct_butterfly_v4(x1, x2,
+		      VSET(T[step*3], T[step*2], T[step], T[0]),
+		      VSET(T[step*3+1], T[step*2+1], T[step+1], T[1]),
+		      1, 1, 0, 0);
+    T+=step*4;
+    x1-=8; x2-=8;
+  }while(T<sincos_lookup0+1024);
+  do{
+    mdct_butterfly_v4(x1, x2,
+		      VSET(T[-step*3], T[-step*2], T[-step], T[0]),
+		      VSET(T[-step*3+1], T[-step*2+1], T[-step+1], T[1]),
+		      0, 1, 1, 1);
+    T-=step*4;
+    x1-=8; x2-=8;
+  }while(T>sincos_lookup0);
+}
+#else
 /* N/stage point generic N stage butterfly (in place, 2 register) */
 static INLINE void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
 
@@ -230,6 +309,7 @@ static INLINE void mdct_butterfly_generic(DATA_TYPE *x,int points,int step){
     x1-=8; x2-=8;
   }while(T>sincos_lookup0);
 }
+#endif
 
 static INLINE void mdct_butterflies(DATA_TYPE *x,int points,int shift){
 
@@ -337,6 +417,35 @@ static INLINE void mdct_bitreverse(DATA_TYPE *x,int n,int step,int shift){
   }while(w0<w1);
 }
 
+#ifdef _V_SIMD
+/* x[0], x[4], x[8], x[12] into *a and x[2], x[6], x[10], x[14] into *b */
+static INLINE void mdct_gather_stride2(const DATA_TYPE *x,vint32_t *a,vint32_t *b){
+  vint32_t e0, e1, o;
+  VUNZIP(VLOAD(x), VLOAD(x+4), e0, o);
+  VUNZIP(VLOAD(x+8), VLOAD(x+12), e1, o);
+  VUNZIP(e0, e1, *a, *b);
+  (void)o;
+}
+
+/* XPROD31() of four (a, b) pairs into x[0..7] as interleaved (x, y) */
+static INLINE void mdct_xprod31_store(DATA_TYPE *x,vint32_t a,vint32_t b,
+				      vint32_t t,vint32_t v){
+  vint32_t lo, hi;
+  VZIP(VADD(VMULT31(a, t), VMULT31(b, v)), VSUB(VMULT31(b, t), VMULT31(a, v)), lo, hi);
+  VSTORE(x, lo);
+  VSTORE(x+4, hi);
+}
+
+/* XNPROD31() counterpart of mdct_xprod31_store() */
+static INLINE void mdct_xnprod31_store(DATA_TYPE *x,vint32_t a,vint32_t b,
+				       vint32_t t,vint32_t v){
+  vint32_t lo, hi;
+  VZIP(VSUB(VMULT31(a, t), VMULT31(b, v)), VADD(VMULT31(b, t), VMULT31(a, v)), lo, hi);
+  VSTORE(x, lo);
+  VSTORE(x+4, hi);
+}
+#endif
+
 void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
   int n2=n>>1;
   int n4=n>>2;
@@ -353,6 +462,59 @@ void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
    
   /* rotate */
 
+#ifdef _V_SIMD
+  /* Two iterations of each scalar loop at a time; both halves run n/32
+     iterations, which is always even. */
+  iX            = in+n2-7;
+  oX            = out+n2+n4;
+  T             = sincos_lookup0;
+
+  do{
+    vint32_t a, b;
+    mdct_gather_stride2(iX-8, &a, &b);
+    oX-=8;
+    mdct_xprod31_store(oX, a, b,
+		       VSET(T[step*3], T[step*2], T[step], T[0]),
+		       VSET(T[step*3+1], T[step*2+1], T[step+1], T[1]));
+    T+=step*4;
+    iX-=16;
+  }while(iX>=in+n4);
+  do{
+    vint32_t a, b;
+    mdct_gather_stride2(iX-8, &a, &b);
+    oX-=8;
+    mdct_xprod31_store(oX, a, b,
+		       VSET(T[-step*3+1], T[-step*2+1], T[-step+1], T[1]),
+		       VSET(T[-step*3], T[-step*2], T[-step], T[0]));
+    T-=step*4;
+    iX-=16;
+  }while(iX>=in);
+
+  iX            = in+n2-8;
+  oX            = out+n2+n4;
+  T             = sincos_lookup0;
+
+  do{
+    vint32_t a, b;
+    mdct_gather_stride2(iX-8, &b, &a);
+    mdct_xnprod31_store(oX, VREVERSE(a), VREVERSE(b),
+			VSET(T[step], T[step*2], T[step*3], T[step*4]),
+			VSET(T[step+1], T[step*2+1], T[step*3+1], T[step*4+1]));
+    T+=step*4;
+    iX-=16;
+    oX+=8;
+  }while(iX>=in+n4);
+  do{
+    vint32_t a, b;
+    mdct_gather_stride2(iX-8, &b, &a);
+    mdct_xnprod31_store(oX, VREVERSE(a), VREVERSE(b),
+			VSET(T[-step+1], T[-step*2+1], T[-step*3+1], T[-step*4+1]),
+			VSET(T[-step], T[-step*2], T[-step*3], T[-step*4]));
+    T-=step*4;
+    iX-=16;
+    oX+=8;
+  }while(iX>=in);
+#else
   iX            = in+n2-7;
   oX            = out+n2+n4;
   T             = sincos_lookup0;
@@ -386,6 +548,7 @@ void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
     iX-=8;
     oX+=4;
   }while(iX>=in);
+#endif
 
   mdct_butterflies(out+n2,n2,shift);
   mdct_bitreverse(out,n,step,shift);
@@ -403,10 +566,23 @@ void mdct_backward(int n, DATA_TYPE *in, DATA_TYPE *out){
         T=(step>=4)?(sincos_lookup0+(step>>1)):sincos_lookup1;
         do{
           oX1-=4;
+#ifdef _V_SIMD
+	  {
+	    vint32_t e, o, c, s;
+	    VUNZIP(VLOAD(iX), VLOAD(iX+4), e, o);
+	    o = VNEG(o);
+	    c = VSET(T[0], T[step], T[step*2], T[step*3]);
+	    s = VSET(T[1], T[step+1], T[step*2+1], T[step*3+1]);
+	    VSTORE(oX1, VREVERSE(VADD(VMULT31(e, c), VMULT31(o, s))));
+	    VSTORE(oX2, VSUB(VMULT31(o, c), VMULT31(e, s)));
+	    T+=step*4;
+	  }
+#else
 	  XPROD31( iX[0], -iX[1], T[0], T[1], &oX1[3], &oX2[0] ); T+=step;
 	  XPROD31( iX[2], -iX[3], T[0], T[1], &oX1[2], &oX2[1] ); T+=step;
 	  XPROD31( iX[4], -iX[5], T[0], T[1], &oX1[1], &oX2[2] ); T+=step;
 	  XPROD31( iX[6], -iX[7], T[0], T[1], &oX1[0], &oX2[3] ); T+=step;
+#endif
 	  oX2+=4;
 	  iX+=8;
 	}while(iX<oX1);
@@ -30,6 +30,7 @@
 #endif
 
 #include "asm_arm.h"
+#include "simd.h"
 #include <stdlib.h> /* for abs() */
   
 #ifndef _V_WIDE_MATH
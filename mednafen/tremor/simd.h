@@ -0,0 +1,163 @@
+/********************************************************************
+ *                                                                  *
+ * THIS FILE IS PART OF THE OggVorbis 'TREMOR' CODEC SOURCE CODE.   *
+ *                                                                  *
+ * USE, DISTRIBUTION AND REPRODUCTION OF THIS LIBRARY SOURCE IS     *
+ * GOVERNED BY A BSD-STYLE SOURCE LICENSE INCLUDED WITH THIS SOURCE *
+ * IN 'COPYING'. PLEASE READ THESE TERMS BEFORE DISTRIBUTING.       *
+ *                                                                  *
+ * THE OggVorbis 'TREMOR' SOURCE CODE IS (C) COPYRIGHT 1994-2002    *
+ * BY THE Xiph.Org FOUNDATION http://www.xiph.org/                  *
+ *                                                                  *
+ ********************************************************************
+
+ function: SSE2 and NEON four-lane versions of the wide math
+           functions, bit-identical to the scalar ones in misc.h
+
+ ********************************************************************/
+
+#ifndef _V_SIMD_H_
+#define _V_SIMD_H_
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#define _V_SIMD
+#include <emmintrin.h>
+
+typedef __m128i vint32_t;
+
+#define VLOAD(p)     _mm_loadu_si128((const __m128i *)(p))
+#define VSTORE(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define VADD(a, b)   _mm_add_epi32((a), (b))
+#define VSUB(a, b)   _mm_sub_epi32((a), (b))
+#define VNEG(a)      _mm_sub_epi32(_mm_setzero_si128(), (a))
+#define VSET(a, b, c, d) _mm_set_epi32((d), (c), (b), (a))
+
+/* (a0 a1 a2 a3) (b0 b1 b2 b3) -> (a0 a2 b0 b2) (a1 a3 b1 b3) */
+#define VUNZIP(a, b, e, o) {						\
+    __m128 _fa = _mm_castsi128_ps(a), _fb = _mm_castsi128_ps(b);	\
+    (e) = _mm_castps_si128(_mm_shuffle_ps(_fa, _fb, _MM_SHUFFLE(2,0,2,0))); \
+    (o) = _mm_castps_si128(_mm_shuffle_ps(_fa, _fb, _MM_SHUFFLE(3,1,3,1))); }
+
+/* inverse of VUNZIP */
+#define VZIP(e, o, a, b) {						\
+    (a) = _mm_unpacklo_epi32((e), (o));					\
+    (b) = _mm_unpackhi_epi32((e), (o)); }
+
+#define VREVERSE(a)  _mm_shuffle_epi32((a), _MM_SHUFFLE(0,1,2,3))
+
+#ifndef _LOW_ACCURACY_
+#define VLOADT(p)    VLOAD(p)
+
+/* MULT32() for each lane; y must be non-negative, which holds for all
+   the lookup tables.  SSE2 only has an unsigned 32x32->64 multiply, so
+   x's sign is fixed up afterwards. */
+static INLINE vint32_t VMULT32(vint32_t x, vint32_t y) {
+  const __m128i even = _mm_mul_epu32(x, y);
+  const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+  const __m128i hi   = _mm_or_si128(_mm_srli_epi64(even, 32),
+				    _mm_and_si128(odd, _mm_set_epi32(-1, 0, -1, 0)));
+
+  return _mm_sub_epi32(hi, _mm_and_si128(y, _mm_srai_epi32(x, 31)));
+}
+
+#define VMULT31(x, y) _mm_slli_epi32(VMULT32((x), (y)), 1)
+
+#else
+/* four LOOKUP_T bytes, widened to int32 */
+static INLINE vint32_t VLOADT(LOOKUP_T *p) {
+  int w;
+
+  memcpy(&w, p, 4);
+  return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(w), _mm_setzero_si128()),
+			    _mm_setzero_si128());
+}
+
+/* low 32 bits of x*y for each lane; SSE2 lacks pmulld */
+static INLINE vint32_t VMULLO(vint32_t x, vint32_t y) {
+  const __m128i even = _mm_mul_epu32(x, y);
+  const __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(y, 32));
+
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0,0,2,0)),
+			    _mm_shuffle_epi32(odd, _MM_SHUFFLE(0,0,2,0)));
+}
+
+#define VMULT32(x, y) VMULLO(_mm_srai_epi32((x), 9), (y))
+#define VMULT31(x, y) VMULLO(_mm_srai_epi32((x), 8), (y))
+#endif
+
+/* CLIP_TO_15(l>>9) and CLIP_TO_15(r>>9), interleaved into eight shorts */
+static INLINE void VCLIP_INTERLEAVE(short *dest, vint32_t l, vint32_t r) {
+  l = _mm_packs_epi32(_mm_srai_epi32(l, 9), _mm_setzero_si128());
+  r = _mm_packs_epi32(_mm_srai_epi32(r, 9), _mm_setzero_si128());
+  _mm_storeu_si128((__m128i *)dest, _mm_unpacklo_epi16(l, r));
+}
+
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define _V_SIMD
+#include <arm_neon.h>
+
+typedef int32x4_t vint32_t;
+
+#define VLOAD(p)     vld1q_s32((const int32_t *)(p))
+#define VSTORE(p, v) vst1q_s32((int32_t *)(p), (v))
+#define VADD(a, b)   vaddq_s32((a), (b))
+#define VSUB(a, b)   vsubq_s32((a), (b))
+#define VNEG(a)      vnegq_s32(a)
+
+static INLINE vint32_t VSET(int32_t a, int32_t b, int32_t c, int32_t d) {
+  const int32_t t[4] = { a, b, c, d };
+  return vld1q_s32(t);
+}
+
+#define VUNZIP(a, b, e, o) {						\
+    int32x4x2_t _u = vuzpq_s32((a), (b));				\
+    (e) = _u.val[0];							\
+    (o) = _u.val[1]; }
+
+#define VZIP(e, o, a, b) {						\
+    int32x4x2_t _z = vzipq_s32((e), (o));				\
+    (a) = _z.val[0];							\
+    (b) = _z.val[1]; }
+
+static INLINE vint32_t VREVERSE(vint32_t a) {
+  a = vrev64q_s32(a);
+  return vcombine_s32(vget_high_s32(a), vget_low_s32(a));
+}
+
+#ifndef _LOW_ACCURACY_
+#define VLOADT(p)    VLOAD(p)
+
+static INLINE vint32_t VMULT32(vint32_t x, vint32_t y) {
+  const int64x2_t lo = vmull_s32(vget_low_s32(x), vget_low_s32(y));
+  const int64x2_t hi = vmull_s32(vget_high_s32(x), vget_high_s32(y));
+
+  return vcombine_s32(vshrn_n_s64(lo, 32), vshrn_n_s64(hi, 32));
+}
+
+#define VMULT31(x, y) vshlq_n_s32(VMULT32((x), (y)), 1)
+
+#else
+static INLINE vint32_t VLOADT(LOOKUP_T *p) {
+  uint32_t w;
+
+  memcpy(&w, p, 4);
+  return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(w))))));
+}
+
+#define VMULT32(x, y) vmulq_s32(vshrq_n_s32((x), 9), (y))
+#define VMULT31(x, y) vmulq_s32(vshrq_n_s32((x), 8), (y))
+#endif
+
+static INLINE void VCLIP_INTERLEAVE(short *dest, vint32_t l, vint32_t r) {
+  int16x4x2_t lr;
+
+  lr.val[0] = vqmovn_s32(vshrq_n_s32(l, 9));
+  lr.val[1] = vqmovn_s32(vshrq_n_s32(r, 9));
+  vst2_s16((int16_t *)dest, lr);
+}
+
+#endif
+
+#endif
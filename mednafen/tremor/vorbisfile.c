@@ -1617,6 +1617,17 @@ long ov_read(OggVorbis_File *vf,char *buffer,int bytes_req,int *bitstream){
     if(samples>(bytes_req/(2*channels)))
       samples=bytes_req/(2*channels);
 
+#ifdef _V_SIMD
+    if(channels==2){
+      short *dest=(short *)buffer;
+      for(j=0;j+4<=samples;j+=4)
+        VCLIP_INTERLEAVE(dest+j*2,VLOAD(pcm[0]+j),VLOAD(pcm[1]+j));
+      for(;j<samples;j++){
+        dest[j*2]=CLIP_TO_15(pcm[0][j]>>9);
+        dest[j*2+1]=CLIP_TO_15(pcm[1][j]>>9);
+      }
+    }else
+#endif
     for(i=0;i<channels;i++) { /* It's faster in this order */
       int32_t *src=pcm[i];
       short *dest=((short *)buffer)+i;
@@ -72,11 +72,20 @@ void _vorbis_apply_window(int32_t *d,const void *window_p[2],
   for(i=0;i<leftbegin;i++)
     d[i]=0;
 
+#ifdef _V_SIMD
+  /* the window halves are at least 32 samples long */
+  for(p=0;i<leftend;i+=4,p+=4)
+    VSTORE(d+i,VMULT31(VLOAD(d+i),VLOADT(window[lW]+p)));
+
+  for(i=rightbegin,p=rn/2-4;i<rightend;i+=4,p-=4)
+    VSTORE(d+i,VMULT31(VLOAD(d+i),VREVERSE(VLOADT(window[nW]+p))));
+#else
   for(p=0;i<leftend;i++,p++)
     d[i]=MULT31(d[i],window[lW][p]);
 
   for(i=rightbegin,p=rn/2-1;i<rightend;i++,p--)
     d[i]=MULT31(d[i],window[nW][p]);
+#endif
 
   for(;i<n;i++)
     d[i]=0;